@@ -19,11 +19,157 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 #include "value.hpp"
 #include "series.hpp"
+#include "strings.hpp"
 
 namespace ren {
 
+class AnyArray;
+
+namespace internal {
+
+//
+// ARRAY BUILDER
+//
+
+//
+// Fills a new array with cells made directly from C++ values.  It's what the
+// array constructors from AnyValues and AnyArray_::from() use, and anything
+// else in the binding that makes a block out of C++ data goes through it
+// too, so there's one place that sizes the array, writes the cells and
+// checks the UTF-8 of strings.  Nothing is scanned, bound or evaluated.
+// While it's being filled the array is held in a BLOCK! so that what the
+// cells refer to is kept alive.  An array can only be made from a builder
+// once.
+//
+
+class ArrayBuilder {
+private:
+    friend class ren::AnyArray;
+
+    AnyValue holder;
+    RenEngineHandle engine;
+
+    void addInteger(int64_t integer);
+    void addDecimal(double decimal);
+    void addText(char const * utf8, size_t size);
+
+public:
+    explicit ArrayBuilder (size_t capacity, Engine * engine = nullptr);
+
+    // For building an array in the engine of a value already in hand
+    //
+    ArrayBuilder (size_t capacity, RenEngineHandle engine);
+
+    ArrayBuilder (ArrayBuilder const &) = delete;
+    ArrayBuilder & operator=(ArrayBuilder const &) = delete;
+
+    void add(AnyValue const & value);
+
+    void add(bool logic);
+
+    template <class T>
+    typename std::enable_if<
+        std::is_integral<T>::value && !std::is_same<T, bool>::value
+    >::type add(T integer) {
+        addInteger(static_cast<int64_t>(integer));
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type add(
+        T decimal
+    ){
+        addDecimal(static_cast<double>(decimal));
+    }
+
+    void add(char const * utf8); // a STRING!
+
+    void add(std::string const & utf8) {
+        addText(utf8.data(), utf8.size());
+    }
+
+#if REN_STRING_VIEW == 1
+    void add(std::string_view utf8) {
+        addText(utf8.data(), utf8.size());
+    }
+#endif
+};
+
+
+// How many elements a range has, if that can be known without going
+// through it (so input iterators give 0, and the array just grows)
+
+template <class Range>
+size_t sizeHint(Range const & range, std::forward_iterator_tag) {
+    return static_cast<size_t>(
+        std::distance(std::begin(range), std::end(range))
+    );
+}
+
+template <class Range>
+size_t sizeHint(Range const &, std::input_iterator_tag) {
+    return 0;
+}
+
+template <class Range>
+size_t sizeHint(Range const & range) {
+    using Iterator = decltype(std::begin(range));
+    return sizeHint(
+        range,
+        typename std::iterator_traits<Iterator>::iterator_category {}
+    );
+}
+
+
+// A vector that AnyArray::extract() fills, with the kind of element it takes
+
+struct Column {
+    enum class Kind { Integer, Decimal, String };
+
+    Kind kind;
+    void * vector;
+};
+
+template <class T>
+struct ColumnKind {
+    static_assert(
+        !std::is_same<T, T>::value, // (false, but only if instantiated)
+        "Arrays can only be extracted into vectors of int64_t, double, or"
+        " std::string"
+    );
+};
+
+template <>
+struct ColumnKind<int64_t> {
+    static Column::Kind get() { return Column::Kind::Integer; }
+};
+
+template <>
+struct ColumnKind<double> {
+    static Column::Kind get() { return Column::Kind::Decimal; }
+};
+
+template <>
+struct ColumnKind<std::string> {
+    static Column::Kind get() { return Column::Kind::String; }
+};
+
+template <class T>
+Column makeColumn(std::vector<T> & vector) {
+    return Column {ColumnKind<T>::get(), &vector};
+}
+
+} // end namespace internal
+
+
 class AnyArray : public AnySeries {
 protected:
     friend class AnyValue;
@@ -66,6 +212,9 @@ protected:
         Engine * engine
     );
 
+    // The values go in as they are, so unlike with Loadables nothing is
+    // bound to the context (only its engine is used)
+    //
     AnyArray (
         AnyValue const values[],
         size_t numValues,
@@ -73,9 +222,298 @@ protected:
         AnyContext const * contextPtr,
         Engine * engine
     );
+
+    AnyArray (internal::ArrayBuilder & builder, internal::CellFunction cellfun);
+
+private:
+    void adopt(internal::ArrayBuilder & builder, internal::CellFunction cellfun);
+
+public:
+    //
+    // An Element is a borrowed reference to a cell in the array, and costs
+    // nothing to make.  hasType() tests it without making a value, and it
+    // converts to an AnyValue (or with static_cast to a more specific type)
+    // by copying the cell out.  So a loop like this allocates nothing for
+    // the elements it skips:
+    //
+    //     for (auto element : block)
+    //         if (hasType<Integer>(element))
+    //             total += static_cast<Integer>(element);
+    //
+    // Assigning to an Element writes into the array's cell, and swapping
+    // two exchanges their cells, which is what lets the std algorithms
+    // permute a block in place.  (Like std::vector<bool>::reference, it's a
+    // proxy: copying an Element copies the reference, not the value.)
+    //
+    // As with iterators into a std::vector, the array must outlive its
+    // iterators and Elements, and inserting or removing invalidates them.
+    //
+    class Element {
+        friend class AnyArray;
+
+        REBVAL const * array; // for the specifier of relative elements
+        REBVAL * cell;
+        RenEngineHandle origin;
+
+        Element (REBVAL const * array, REBVAL * cell, RenEngineHandle origin) :
+            array (array),
+            cell (cell),
+            origin (origin)
+        {
+        }
+
+    public:
+        Element (Element const & other) = default;
+
+        // These throw if the array is protected.  They're const because it's
+        // the reference that is const, not what it refers to.
+        //
+        Element const & operator=(AnyValue const & value) const;
+        Element const & operator=(Element const & other) const;
+
+        friend void swap(Element a, Element b);
+
+        operator AnyValue () const {
+            return AnyValue::fromElement_<AnyValue>(cell, array, origin);
+        }
+
+        template <
+            class T,
+            typename = typename std::enable_if<
+                std::is_base_of<AnyValue, T>::value
+                && !std::is_same<AnyValue, T>::value
+            >::type
+        >
+        explicit operator T () const {
+            if (!AnyValue::isValidCell_<T>(cell))
+                throw bad_value_cast("Invalid cast");
+            return AnyValue::fromElement_<T>(cell, array, origin);
+        }
+
+        // see the ren::hasType() overload below
+        //
+        template <class T>
+        bool hasType_() const {
+            return AnyValue::isValidCell_<T>(cell);
+        }
+
+        // As with AnyValue, these compare the cells directly
+        //
+        bool isEqualTo(AnyValue const & other) const;
+        bool isSameAs(AnyValue const & other) const;
+
+        // So `it->isEqualTo(...)` works on an iterator, which gives back an
+        // Element from its operator->
+        //
+        Element const * operator->() const { return this; }
+    };
+
+
+    //
+    // Like AnySeries::iterator, this is the array's cell and an index, but
+    // dereferences to an Element instead of making an AnyValue.  It's
+    // random access, so the std algorithms work on blocks in place:
+    //
+    //     std::sort(block.begin(), block.end(), AnyArray::Less {});
+    //
+    //     auto it = std::lower_bound(
+    //         block.begin(), block.end(), Integer {10}, AnyArray::Less {}
+    //     );
+    //
+    // (The algorithms that hold a value aside, like insertion sorting, will
+    // make an AnyValue for it.  AnyArray::sort() doesn't.)
+    //
+    class iterator {
+        friend class AnyArray;
+
+        REBVAL const * array;
+        size_t index;
+        RenEngineHandle origin;
+
+        iterator (REBVAL const * array, size_t index, RenEngineHandle origin) :
+            array (array),
+            index (index),
+            origin (origin)
+        {
+        }
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus >= 202002L
+        using iterator_concept = std::random_access_iterator_tag;
+#endif
+        using value_type = AnyValue;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Element;
+        using reference = Element;
+
+        iterator () : array (nullptr), index (0), origin () {}
+
+        iterator & operator++() {
+            ++index;
+            return *this;
+        }
+
+        iterator & operator--() {
+            --index;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto temp = *this;
+            operator++();
+            return temp;
+        }
+
+        iterator operator--(int) {
+            auto temp = *this;
+            operator--();
+            return temp;
+        }
+
+        iterator & operator+=(difference_type n) {
+            index = static_cast<size_t>(static_cast<difference_type>(index) + n);
+            return *this;
+        }
+
+        iterator & operator-=(difference_type n) { return *this += -n; }
+
+        iterator operator+(difference_type n) const {
+            auto temp = *this;
+            return temp += n;
+        }
+
+        friend iterator operator+(difference_type n, iterator const & it) {
+            return it + n;
+        }
+
+        iterator operator-(difference_type n) const {
+            auto temp = *this;
+            return temp -= n;
+        }
+
+        difference_type operator-(iterator const & other) const {
+            return static_cast<difference_type>(index)
+                - static_cast<difference_type>(other.index);
+        }
+
+        bool operator==(iterator const & other) const
+            { return index == other.index; }
+        bool operator!=(iterator const & other) const
+            { return index != other.index; }
+        bool operator<(iterator const & other) const
+            { return index < other.index; }
+        bool operator>(iterator const & other) const
+            { return index > other.index; }
+        bool operator<=(iterator const & other) const
+            { return index <= other.index; }
+        bool operator>=(iterator const & other) const
+            { return index >= other.index; }
+
+        Element operator * () const;
+        Element operator-> () const { return *(*this); }
+        Element operator[](difference_type n) const { return *(*this + n); }
+    };
+
+    iterator begin() const;
+
+    iterator end() const;
+
+
+    //
+    // Orders values the way SORT does by default (strings and words without
+    // regard to case), and takes Elements or AnyValues in any combination.
+    // Integers, decimals and strings compared with their own kind skip the
+    // general comparison.
+    //
+    class Less {
+    private:
+        static bool lessCells(REBVAL const * a, REBVAL const * b);
+
+    public:
+        bool operator()(Element const & a, Element const & b) const
+            { return lessCells(a.cell, b.cell); }
+        bool operator()(Element const & a, AnyValue const & b) const
+            { return lessCells(a.cell, b.cell); }
+        bool operator()(AnyValue const & a, Element const & b) const
+            { return lessCells(a.cell, b.cell); }
+        bool operator()(AnyValue const & a, AnyValue const & b) const
+            { return lessCells(a.cell, b.cell); }
+    };
+
+
+    // Sorts from the array's position to its tail, in place, ordering as
+    // Less does.  Equal values keep their order.  If all the values are
+    // integers or all are decimals, it sorts their numbers unboxed.  Throws
+    // if the array is protected.
+    //
+    void sort();
+
+
+    //
+    // Modifying in place (see the notes in AnySeries).  The values go in as
+    // they are, without being copied or bound.
+    //
+    void append(AnyValue const & value);
+
+    void insert(size_t offset, AnyValue const & value);
+
+    void poke(size_t offset, AnyValue const & value);
+
+    // Offset of the first element equal to `value` (as FIND compares them),
+    // or npos
+    //
+    size_t find(AnyValue const & value) const;
+
+
+    //
+    // Copying elements out into C++ vectors, from the position to the tail,
+    // in one pass over the cells.  int64_t takes INTEGER!, double takes
+    // DECIMAL! or INTEGER!, and std::string takes any string type as UTF-8.
+    // The vectors are resized to fit, so reusing them between calls reuses
+    // their memory:
+    //
+    //     std::vector<double> prices;
+    //     block.extract(prices);
+    //
+    // extractColumns() takes the elements as rows of fixed width, one
+    // vector per column.  So `[1 "a" 1.5  2 "b" 2.5]` into vectors of
+    // int64_t, std::string, and double gives each of them two elements:
+    //
+    //     block.extractColumns(ids, names, scores);
+    //
+    // An element of the wrong type raises a bad_value_cast saying where it
+    // is, as does a length that isn't a whole number of rows.  What was put
+    // into the vectors before that is left in them.
+    //
+    template <class T>
+    void extract(std::vector<T> & out) const {
+        internal::Column column = internal::makeColumn(out);
+        extractInto(&column, 1);
+    }
+
+    template <class... Ts>
+    void extractColumns(std::vector<Ts> &... columns) const {
+        static_assert(sizeof...(Ts) != 0, "extractColumns() needs columns");
+        internal::Column all[] = {internal::makeColumn(columns)...};
+        extractInto(all, sizeof...(Ts));
+    }
+
+private:
+    void extractInto(internal::Column const columns[], size_t count) const;
 };
 
 
+template <class T>
+bool hasType(AnyArray::Element const & element) {
+    static_assert(
+        std::is_base_of<AnyValue, T>::value,
+        "Only types derived from AnyValue may be tested by ren::hasType()"
+    );
+    return element.hasType_<T>();
+}
+
+
 
 namespace internal {
 
@@ -167,6 +605,29 @@ public:
     {
     }
 
+    explicit AnyArray_ (ArrayBuilder & builder) :
+        AnyArray (builder, F)
+    {
+    }
+
+
+    // Makes the array from a container (or other range) in one pass, with
+    // the cells written directly instead of going through AnyValues or the
+    // scanner.  Integral types become INTEGER!, floating point DECIMAL!,
+    // bool LOGIC!, and std::string or char const * a STRING! (from UTF-8).
+    // Anything else must be an AnyValue.
+    //
+    //     std::vector<double> prices = ...;
+    //     Block block = Block::from(prices);
+    //
+    template <class Range>
+    static C from(Range const & range, Engine * engine = nullptr) {
+        ArrayBuilder builder {sizeHint(range), engine};
+        for (auto const & item : range)
+            builder.add(item);
+        return C (builder);
+    }
+
     // A block can be invoked something like a function via DO, so it makes
     // sense for it to have a way of applying it...but it doesn't take
     // any "parameters"
@@ -207,6 +668,153 @@ public:
 };
 
 
+
+//
+// BLOCKS OF ONE TYPE
+//
+
+//
+// Looping over a block with `static_cast<Integer>(element)` checks each
+// element's type and makes a value for it, every time around.  A BlockOf
+// checks the types of all the elements once, when it's made, and after that
+// reads them straight out of the block's cells.  Nothing is copied:
+//
+//     BlockOf<Integer> counts {block}; // bad_value_cast if not all INTEGER!
+//     int64_t total = std::accumulate(counts.begin(), counts.end(), 0LL);
+//
+// The elements of a BlockOf<Integer> must all be INTEGER!, and read as
+// int64_t.  Those of a BlockOf<Float> must all be DECIMAL! (an INTEGER! is
+// not converted, as it is by extract()), and read as double.  Those of a
+// BlockOf<String> must all be STRING!, and read as the string's utf8View(),
+// which only copies text that isn't ASCII.
+//
+// A function made with Function::construct can take a BlockOf parameter.
+// The argument is checked when the function is called, before the C++
+// code runs, and a failed check is an error in the caller:
+//
+//     auto sum = Function::construct(
+//         "{Sum of integers} values [block!]",
+//         [](BlockOf<Integer> const & values) -> Integer {...}
+//     );
+//
+// The BlockOf holds a reference to the block, so it won't be GC'd.  !!! As
+// with a Codepoints range, the block must not be modified while the BlockOf
+// is in use; the types were only checked once.
+//
+
+class Integer;
+class Float;
+
+namespace internal {
+
+// What a BlockOf<T> element reads as, and the code that checks the block's
+// elements (returning how many there are) and reads one (see %arrays.cpp)
+
+template <class T>
+struct BlockOfElement {
+    static_assert(
+        !std::is_same<T, T>::value, // (false, but only if instantiated)
+        "BlockOf<T> is only for Integer, Float, and String"
+    );
+};
+
+template <>
+struct BlockOfElement<Integer> {
+    using type = int64_t;
+    static size_t check(Block const & block);
+    static type at(Block const & block, size_t offset);
+};
+
+template <>
+struct BlockOfElement<Float> {
+    using type = double;
+    static size_t check(Block const & block);
+    static type at(Block const & block, size_t offset);
+};
+
+template <>
+struct BlockOfElement<String> {
+    using type = AnyString::Utf8View;
+    static size_t check(Block const & block);
+    static type at(Block const & block, size_t offset);
+};
+
+} // end namespace internal
+
+
+template <class T>
+class BlockOf {
+private:
+    using Element = internal::BlockOfElement<T>;
+
+public:
+    using value_type = typename Element::type;
+
+private:
+    Block source;
+    size_t length;
+
+public:
+    BlockOf (Block const & block) : // implicit, for function arguments
+        source (block),
+        length (Element::check(block))
+    {
+    }
+
+    Block const & block() const { return source; }
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    value_type operator[](size_t offset) const {
+        return Element::at(source, offset);
+    }
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename Element::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+    private:
+        friend class BlockOf;
+        BlockOf const * owner;
+        size_t offset;
+
+        const_iterator (BlockOf const * owner, size_t offset) :
+            owner (owner), offset (offset) {}
+
+    public:
+        value_type operator*() const { return (*owner)[offset]; }
+
+        const_iterator & operator++() { ++offset; return *this; }
+        const_iterator operator++(int) { auto t = *this; ++offset; return t; }
+
+        bool operator==(const_iterator const & other) const {
+            return offset == other.offset;
+        }
+        bool operator!=(const_iterator const & other) const {
+            return offset != other.offset;
+        }
+    };
+
+    const_iterator begin() const { return const_iterator {this, 0}; }
+    const_iterator end() const { return const_iterator {this, length}; }
+};
+
+
+namespace internal {
+
+template <class T>
+struct ArgumentCell<BlockOf<T>> {
+    using type = Block;
+};
+
+} // end namespace internal
+
+
 class Group
     : public internal::AnyArray_<Group, &AnyArray::initGroup>
 {
@@ -0,0 +1,119 @@
+#ifndef RENCPP_BINARY_HPP
+#define RENCPP_BINARY_HPP
+
+//
+// binary.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+#include "series.hpp"
+
+
+namespace ren {
+
+
+//
+// BINARY
+//
+
+//
+// Bytes for Ren code, without going through a string or a `#{...}` literal
+// that has to be scanned:
+//
+//     std::vector<unsigned char> packet = receive();
+//     runtime("handle-packet", Binary {packet}); // one copy, in one memcpy
+//
+//     Binary image = Binary::readFile("photo.jpg");
+//     runtime("decode-jpeg", image);
+//
+// data() points at the byte at the binary's position, with no copying.  Like
+// a pointer into a std::vector, it's good until the binary is modified in a
+// way that could reallocate it (appending, inserting, reserve()).
+//
+// A BINARY! is limited to 4 gigabytes; more throws std::invalid_argument.
+//
+
+class Binary : public AnySeries {
+protected:
+    friend class AnyValue;
+    Binary (Dont) noexcept : AnySeries (Dont::Initialize) {}
+    static bool isValid(REBVAL const * cell);
+
+private:
+    // Makes the series with `size` bytes not yet filled in, and gives back
+    // where they go
+    //
+    unsigned char * initBinary(size_t size, Engine * engine);
+
+public:
+    Binary (
+        unsigned char const * data,
+        size_t size,
+        Engine * engine = nullptr
+    );
+
+    explicit Binary (
+        std::vector<unsigned char> const & bytes,
+        Engine * engine = nullptr
+    ) :
+        Binary (bytes.data(), bytes.size(), engine)
+    {
+    }
+
+#if REN_SPAN == 1
+    explicit Binary (
+        std::span<std::byte const> bytes,
+        Engine * engine = nullptr
+    ) :
+        Binary (
+            reinterpret_cast<unsigned char const *>(bytes.data()),
+            bytes.size(),
+            engine
+        )
+    {
+    }
+#endif
+
+    // The contents of a file, copied into a new series.  The bytes are read
+    // straight into the BINARY!, with no buffer in between, but unlike a
+    // memory mapping they're a copy: the file can change or go away after.
+    // Pipes and files that give no size (e.g. in /proc) are read until end
+    // of file.  Throws std::runtime_error if the file can't be read.
+    //
+    static Binary readFile(
+        std::string const & path,
+        Engine * engine = nullptr
+    );
+
+    unsigned char * data() const;
+
+#if REN_SPAN == 1
+    std::span<std::byte> span() const {
+        return std::span<std::byte> {
+            reinterpret_cast<std::byte *>(data()), length()
+        };
+    }
+#endif
+};
+
+} // end namespace ren
+
+#endif
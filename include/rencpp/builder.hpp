@@ -0,0 +1,153 @@
+#ifndef RENCPP_BUILDER_HPP
+#define RENCPP_BUILDER_HPP
+
+//
+// builder.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#include "value.hpp"
+#include "strings.hpp"
+
+
+namespace ren {
+
+
+//
+// BUILDING STRINGS FROM C++
+//
+
+//
+// Making a long string out of many pieces with `runtime("append", s, x)`
+// pays for an evaluation per piece, and building a std::string first means
+// copying it all again to make the String.  A StringBuilder writes straight
+// into the series that will become the String:
+//
+//     StringBuilder builder;
+//     for (auto & row : rows)
+//         builder.append(row.name).appendChar(U'\t')
+//             .appendInteger(row.count).appendChar(U'\n');
+//     String report = builder.finish(); // no copy
+//
+// The series' capacity doubles when it runs out, so appends are amortized
+// constant time.  Like the interpreter's own strings, it starts out with a
+// byte per character and is widened the first time a character that isn't
+// Latin-1 is appended.
+//
+// stream() is a std::ostream that writes into the builder, so code with
+// existing operator<< overloads can be pointed at it:
+//
+//     builder.stream() << std::setw(8) << total << " bytes\n";
+//
+// Text is UTF-8 (invalid UTF-8 throws).  What has been written to the stream
+// is put into the string by finish(), or when the stream is flushed.
+//
+// !!! A builder is used by one thread at a time, under the EvaluatorLock if
+// other threads may be evaluating, as with any values.
+//
+
+class StringBuilder {
+private:
+    class Buffer : public std::streambuf {
+    private:
+        StringBuilder & builder;
+        char space[256];
+
+    public:
+        explicit Buffer (StringBuilder & builder);
+
+    protected:
+        int_type overflow(int_type c) override;
+        int sync() override;
+    };
+
+    Engine * engine;
+
+    optional<String> target;
+    void * series; // the target's REBSER *
+    unsigned char * data; // series data, moves when the series grows
+    size_t wide; // bytes per character, 1 until widened
+    size_t used; // characters written
+    size_t capacity; // characters that fit without growing
+
+    // The stream can split a UTF-8 sequence across two writes
+    //
+    unsigned char pending[4];
+    size_t pendingSize;
+
+    Buffer buffer;
+    std::ostream out;
+
+    void start();
+    void reset();
+    void reserveMore(size_t count);
+    void widen();
+    void put(uint32_t codepoint);
+    void appendUtf8(char const * utf8, size_t size, bool partial);
+
+public:
+    explicit StringBuilder (size_t reserve = 0, Engine * engine = nullptr);
+
+    StringBuilder (StringBuilder const &) = delete;
+    StringBuilder & operator=(StringBuilder const &) = delete;
+
+    StringBuilder & append(char const * utf8, size_t size);
+
+    StringBuilder & append(char const * utf8);
+
+    StringBuilder & append(std::string const & str) {
+        return append(str.data(), str.size());
+    }
+
+#if REN_STRING_VIEW == 1
+    StringBuilder & append(std::string_view str) {
+        return append(str.data(), str.size());
+    }
+#endif
+
+    StringBuilder & appendChar(char32_t codepoint);
+
+    StringBuilder & appendInteger(int64_t value);
+
+    // Appends what FORM would give, without making a separate string
+    // for it in C++.
+    //
+    StringBuilder & appendFormed(AnyValue const & value);
+
+    std::ostream & stream() { return out; }
+
+    // Characters so far, not counting what's unflushed in the stream
+    //
+    size_t length() const { return used; }
+
+    void reserve(size_t count);
+
+    // Hands over the series as a String.  The builder is then empty, and
+    // can be used to build another.  If invalid UTF-8 was written to the
+    // stream, this throws std::runtime_error instead, and the builder is
+    // emptied all the same.
+    //
+    String finish();
+};
+
+} // end namespace ren
+
+#endif
@@ -48,6 +48,44 @@
 
 
 
+//
+// STD::STRING_VIEW
+//
+
+//
+// The binding targets C++11, but when built as C++17 the classes that take
+// or give out text also offer std::string_view overloads, so callers with
+// views don't have to make a std::string just to pass one in.
+//
+
+#if __cplusplus >= 201703L
+    #include <string_view>
+    #define REN_STRING_VIEW 1
+#else
+    #define REN_STRING_VIEW 0
+#endif
+
+
+
+//
+// STD::SPAN
+//
+
+//
+// Likewise, when built as C++20 the classes that hold runs of plain numbers
+// or bytes (VECTOR!, BINARY!) offer std::span views of them.  Under C++11
+// the same data is available as a pointer and a length.
+//
+
+#if __cplusplus >= 202002L
+    #include <span>
+    #define REN_SPAN 1
+#else
+    #define REN_SPAN 0
+#endif
+
+
+
 //
 // UNREACHABLE CODE MACRO
 //
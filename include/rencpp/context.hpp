@@ -1,244 +1,392 @@
-#ifndef RENCPP_CONTEXT_HPP
-#define RENCPP_CONTEXT_HPP
-
-//
-// context.hpp
-// This file is part of RenCpp
-// Copyright (C) 2015-2018 HostileFork.com
-//
-// Licensed under the Boost License, Version 1.0 (the "License")
-//
-//      http://www.boost.org/LICENSE_1_0.txt
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
-// implied.  See the License for the specific language governing
-// permissions and limitations under the License.
-//
-// See http://rencpp.hostilefork.com for more information on this project
-//
-
-#include <functional>
-
-#include "value.hpp"
-#include "runtime.hpp"
-
-namespace ren {
-
-
-//
-// CONTEXT FOR BINDING
-//
-
-//
-// Historically the Rebol language used the terms CONTEXT and OBJECT somewhat
-// interchangeably, although the data type was called OBJECT!  Ren-C has
-// redefined the terminology so that ANY-CONTEXT! is the superclass of
-// ERROR!, OBJECT!, PORT! etc. (in the spirit of not having the superclass
-// share a name with any specific member of said class).
-//
-// !!! Under Rebol's hood, an object was implemented as a pair of series.
-// Accessing the object by position was not allowed, though some natives
-// offered features that demonstrated positional awareness (e.g. SET).
-// This is likely to be deprecated in favor of more fluidity in the
-// implementation of object.
-//
-
-class Engine;
-
-class AnyContext : public AnyValue {
-protected:
-    friend class AnyValue;
-    AnyContext (Dont) noexcept : AnyValue (Dont::Initialize) {}
-    static bool isValid(REBVAL const * cell);
-
-    // Friending doesn't seem to be enough for gcc 4.6, see SO writeup:
-    //    http://stackoverflow.com/questions/32983193/
-public:
-    friend class Object;
-    static void initObject(REBVAL *cell);
-    friend class Error;
-    static void initError(REBVAL *cell);
-    //
-    // !!! Ports, Modules, Frames... (just Object and error for starters)
-    //
-
-public:
-    AnyContext copy(bool deep = true) {
-        return static_cast<AnyContext>(AnyValue::copy(deep));
-    }
-
-public:
-    using Finder = std::function<AnyContext (Engine *)>;
-
-private:
-    friend class AnyArray;
-    friend class AnyString;
-    friend class AnyWord;
-    friend class Runtime;
-
-    static Finder finder;
-    RenEngineHandle getEngine() const { return origin; }
-
-public:
-
-    static AnyContext lookup(char const * name, Engine * engine = nullptr);
-
-    static Finder setFinder(
-        Finder const & newFinder
-    ) {
-        auto result = finder;
-        finder = newFinder;
-        return result;
-    }
-
-    // The reason that context finding is dependent on the engine has to do
-    // with the default execution for Engine e; then e(...)
-    // If there was only a context finder that didn't depend on the engine,
-    // such calls could return a context from the wrong engine.
-    //
-    // Passing as a pointer in order to be able to optimize out the cases
-    // where you don't care, but the parameter is there if you want to use it
-
-    static AnyContext current(Engine * engine = nullptr);
-
-
-    // Patterned after AnyArray; you can construct a context from the same
-    // data that can be used to make a block.
-protected:
-    AnyContext (
-        internal::Loadable const loadables[],
-        size_t numLoadables,
-        internal::CellFunction F,
-        AnyContext const * contextPtr,
-        Engine * engine
-    );
-
-    AnyContext (
-        AnyValue const values[],
-        size_t numValues,
-        internal::CellFunction F,
-        AnyContext const * contextPtr,
-        Engine * engine
-    );
-
-
-    // If you use the apply operation in a context, then it means "do this
-    // code in this context"
-    //
-public:
-    template <typename... Ts>
-    inline optional<AnyValue> operator()(Ts &&... args) const {
-        return apply(
-            {std::forward<Ts>(args)...},
-            internal::ContextWrapper {*this}
-        );
-    }
-
-    template <typename R, typename... Ts>
-    inline R create(Ts &&... args) const {
-        return R {
-            {std::forward<Ts>(args)...},
-            internal::ContextWrapper {*this}
-        };
-    }
-};
-
-
-namespace internal {
-
-//
-// ANYCONTEXT_ SUBTYPE HELPER
-//
-
-template <class C, CellFunction F>
-class AnyContext_ : public AnyContext {
-protected:
-    friend class AnyValue;
-    AnyContext_ (Dont) : AnyContext (Dont::Initialize) {}
-
-public:
-    AnyContext_ (
-        AnyValue const values[],
-        size_t numValues,
-        internal::ContextWrapper const & wrapper
-    ) :
-        AnyContext (values, numValues, F, &wrapper.context, nullptr)
-    {
-    }
-
-    AnyContext_ (
-        AnyValue const values[],
-        size_t numValues,
-        Engine * engine
-    ) :
-        AnyContext (values, numValues, F, nullptr, engine)
-    {
-    }
-
-    AnyContext_ (
-        std::initializer_list<Loadable> const & loadables,
-        internal::ContextWrapper const & wrapper
-    ) :
-        AnyContext (
-            loadables.begin(),
-            loadables.size(),
-            F,
-            &wrapper.context,
-            nullptr
-        )
-    {
-    }
-
-    AnyContext_ (AnyContext const & context) :
-        AnyContext (static_cast<Loadable *>(nullptr), 0, F, &context, nullptr)
-    {
-    }
-
-    AnyContext_ (
-        std::initializer_list<Loadable> const & loadables,
-        Engine * engine = nullptr
-    ) :
-        AnyContext (loadables.begin(), loadables.size(), F, nullptr, engine)
-    {
-    }
-
-    AnyContext_ (Engine * engine = nullptr) :
-        AnyContext (static_cast<Loadable *>(nullptr), 0, F, nullptr, engine)
-    {
-    }
-};
-
-} // end namespace internal
-
-
-
-//
-// CONCRETE CONTEXT TYPES
-//
-
-//
-// For why these are classes and not typedefs:
-//
-//     https://github.com/hostilefork/rencpp/issues/49
-//
-
-
-class Object
-    : public internal::AnyContext_<Object, &AnyContext::initObject>
-{
-    using AnyContext::initObject;
-
-protected:
-    static bool isValid(REBVAL const * cell);
-
-public:
-    friend class AnyValue;
-    using internal::AnyContext_<Object, &AnyContext::initObject>::AnyContext_;
-};
-
-
-} // end namespace ren
-
-#endif
+#ifndef RENCPP_CONTEXT_HPP
+#define RENCPP_CONTEXT_HPP
+
+//
+// context.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "value.hpp"
+#include "runtime.hpp"
+
+namespace ren {
+
+
+//
+// CONTEXT FOR BINDING
+//
+
+//
+// Historically the Rebol language used the terms CONTEXT and OBJECT somewhat
+// interchangeably, although the data type was called OBJECT!  Ren-C has
+// redefined the terminology so that ANY-CONTEXT! is the superclass of
+// ERROR!, OBJECT!, PORT! etc. (in the spirit of not having the superclass
+// share a name with any specific member of said class).
+//
+// !!! Under Rebol's hood, an object was implemented as a pair of series.
+// Accessing the object by position was not allowed, though some natives
+// offered features that demonstrated positional awareness (e.g. SET).
+// This is likely to be deprecated in favor of more fluidity in the
+// implementation of object.
+//
+
+class Engine;
+
+class AnyContext : public AnyValue {
+protected:
+    friend class AnyValue;
+    AnyContext (Dont) noexcept : AnyValue (Dont::Initialize) {}
+    static bool isValid(REBVAL const * cell);
+
+    // Friending doesn't seem to be enough for gcc 4.6, see SO writeup:
+    //    http://stackoverflow.com/questions/32983193/
+public:
+    friend class Object;
+    static void initObject(REBVAL *cell);
+    friend class Error;
+    static void initError(REBVAL *cell);
+    //
+    // !!! Ports, Modules, Frames... (just Object and error for starters)
+    //
+
+public:
+    AnyContext copy(bool deep = true) {
+        return static_cast<AnyContext>(AnyValue::copy(deep));
+    }
+
+public:
+    using Finder = std::function<AnyContext (Engine *)>;
+
+private:
+    friend class AnyArray;
+    friend class AnyString;
+    friend class AnyWord;
+    friend class Runtime;
+
+    static Finder finder;
+    RenEngineHandle getEngine() const { return origin; }
+
+    friend class ContextScope;
+    static thread_local AnyContext const * scoped; // innermost ContextScope
+    static thread_local AnyContext const * cachedUser;
+
+    static AnyContext const & user(Engine * engine);
+
+    // Like current(), but without copying the context when it comes from a
+    // ContextScope or is the default.  Only if a finder has to be called is
+    // its result put into `holder`, which must outlive the reference.
+    //
+    static AnyContext const & resolve(
+        Engine * engine,
+        optional<AnyContext> & holder
+    );
+
+public:
+
+    static AnyContext lookup(char const * name, Engine * engine = nullptr);
+
+    static Finder setFinder(
+        Finder const & newFinder
+    ) {
+        auto result = finder;
+        finder = newFinder;
+        return result;
+    }
+
+    // The reason that context finding is dependent on the engine has to do
+    // with the default execution for Engine e; then e(...)
+    // If there was only a context finder that didn't depend on the engine,
+    // such calls could return a context from the wrong engine.
+    //
+    // Passing as a pointer in order to be able to optimize out the cases
+    // where you don't care, but the parameter is there if you want to use it
+
+    static AnyContext current(Engine * engine = nullptr);
+
+
+    // Patterned after AnyArray; you can construct a context from the same
+    // data that can be used to make a block.
+protected:
+    AnyContext (
+        internal::Loadable const loadables[],
+        size_t numLoadables,
+        internal::CellFunction F,
+        AnyContext const * contextPtr,
+        Engine * engine
+    );
+
+    AnyContext (
+        AnyValue const values[],
+        size_t numValues,
+        internal::CellFunction F,
+        AnyContext const * contextPtr,
+        Engine * engine
+    );
+
+
+    // If you use the apply operation in a context, then it means "do this
+    // code in this context"
+    //
+public:
+    template <typename... Ts>
+    inline optional<AnyValue> operator()(Ts &&... args) const {
+        return apply(
+            {std::forward<Ts>(args)...},
+            internal::ContextWrapper {*this}
+        );
+    }
+
+    template <typename R, typename... Ts>
+    inline R create(Ts &&... args) const {
+        return R {
+            {std::forward<Ts>(args)...},
+            internal::ContextWrapper {*this}
+        };
+    }
+};
+
+
+namespace internal {
+
+//
+// ANYCONTEXT_ SUBTYPE HELPER
+//
+
+template <class C, CellFunction F>
+class AnyContext_ : public AnyContext {
+protected:
+    friend class AnyValue;
+    AnyContext_ (Dont) : AnyContext (Dont::Initialize) {}
+
+public:
+    AnyContext_ (
+        AnyValue const values[],
+        size_t numValues,
+        internal::ContextWrapper const & wrapper
+    ) :
+        AnyContext (values, numValues, F, &wrapper.context, nullptr)
+    {
+    }
+
+    AnyContext_ (
+        AnyValue const values[],
+        size_t numValues,
+        Engine * engine
+    ) :
+        AnyContext (values, numValues, F, nullptr, engine)
+    {
+    }
+
+    AnyContext_ (
+        std::initializer_list<Loadable> const & loadables,
+        internal::ContextWrapper const & wrapper
+    ) :
+        AnyContext (
+            loadables.begin(),
+            loadables.size(),
+            F,
+            &wrapper.context,
+            nullptr
+        )
+    {
+    }
+
+    AnyContext_ (AnyContext const & context) :
+        AnyContext (static_cast<Loadable *>(nullptr), 0, F, &context, nullptr)
+    {
+    }
+
+    AnyContext_ (
+        std::initializer_list<Loadable> const & loadables,
+        Engine * engine = nullptr
+    ) :
+        AnyContext (loadables.begin(), loadables.size(), F, nullptr, engine)
+    {
+    }
+
+    AnyContext_ (Engine * engine = nullptr) :
+        AnyContext (static_cast<Loadable *>(nullptr), 0, F, nullptr, engine)
+    {
+    }
+};
+
+} // end namespace internal
+
+
+
+//
+// CONCRETE CONTEXT TYPES
+//
+
+//
+// For why these are classes and not typedefs:
+//
+//     https://github.com/hostilefork/rencpp/issues/49
+//
+
+
+class Object
+    : public internal::AnyContext_<Object, &AnyContext::initObject>
+{
+    using AnyContext::initObject;
+
+protected:
+    static bool isValid(REBVAL const * cell);
+
+public:
+    friend class AnyValue;
+    using internal::AnyContext_<Object, &AnyContext::initObject>::AnyContext_;
+};
+
+
+
+//
+// SCOPED CONTEXT OVERRIDE
+//
+
+//
+// Makes `context` the one that code is bound into by default on this thread
+// (e.g. by `runtime(...)`) for the lifetime of the scope, without calling
+// the finder.  The context must outlive the scope.  Scopes may be nested.
+//
+//     Object sandbox {};
+//     {
+//         ContextScope scope {sandbox};
+//         runtime("x: 10"); // sets x in the sandbox
+//     }
+//
+
+class ContextScope {
+private:
+    AnyContext const * previous;
+
+public:
+    explicit ContextScope (AnyContext const & context) :
+        previous (AnyContext::scoped)
+    {
+        AnyContext::scoped = &context;
+    }
+
+    ContextScope (ContextScope const &) = delete;
+    ContextScope & operator=(ContextScope const &) = delete;
+
+    ~ContextScope () {
+        AnyContext::scoped = previous;
+    }
+};
+
+
+
+//
+// POOLED CONTEXTS FOR ISOLATION
+//
+
+//
+// Running each request in its own `Object {}` keeps requests from seeing
+// each other's variables, but a fresh object costs a context allocation, and
+// every word the code uses must be resolved against lib the first time it
+// is seen.  A ContextPool pays for that once: the template is copied and
+// extended with all of lib's words when the pool is made, and the pool then
+// keeps copies of that "warm" context to lend out.
+//
+//     ContextPool pool {Object {"limit: 10"}, 8};
+//
+//     {
+//         ContextPool::Lease sandbox = pool.acquire();
+//         (*sandbox)("x: limit * 2");
+//     } // x is gone again for the next request
+//
+// When a lease ends, the context's variables are reset to the template's
+// values in place.  If the code added new words to the context, or PROTECTed
+// or hid any of it, it can't be reset that way, so it's dropped and replaced
+// with a fresh copy.  If all
+// the contexts are out, acquire() makes another one rather than waiting.
+//
+// The pool may be used from several threads, but as with any values the
+// EvaluatorLock must be held when other threads are evaluating (including
+// while a Lease is destroyed).  The pool must outlive its leases.
+//
+// !!! The reset is shallow, like the copy: a series in a template variable
+// is shared by all the contexts, so code that modifies it in place will be
+// seen by later requests.
+//
+
+class ContextPool {
+public:
+    class Lease {
+    private:
+        friend class ContextPool;
+
+        ContextPool * pool;
+        optional<Object> context;
+
+        Lease (ContextPool & pool, Object && context) :
+            pool (&pool),
+            context (std::move(context))
+        {
+        }
+
+    public:
+        Lease (Lease && other) :
+            pool (other.pool),
+            context (std::move(other.context))
+        {
+            other.pool = nullptr;
+        }
+
+        Lease (Lease const &) = delete;
+        Lease & operator=(Lease const &) = delete;
+        Lease & operator=(Lease &&) = delete;
+
+        Object const & operator*() const { return *context; }
+        Object const * operator->() const { return &*context; }
+
+        // Give the context back before the Lease is destroyed.  This
+        // doesn't throw: a context that can't be returned is dropped.
+        //
+        void release() noexcept;
+
+        ~Lease () { release(); }
+    };
+
+private:
+    Object warm;
+    mutable std::mutex mutex;
+    std::vector<Object> idle;
+
+    Object clone() const;
+    bool reset(Object const & context) const noexcept;
+    void giveBack(Object && context) noexcept;
+
+public:
+    ContextPool (Object const & templateObject, size_t count);
+
+    ContextPool (ContextPool const &) = delete;
+    ContextPool & operator=(ContextPool const &) = delete;
+
+    Lease acquire();
+
+    size_t available() const;
+};
+
+} // end namespace ren
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef RENCPP_COROUTINE_HPP
+#define RENCPP_COROUTINE_HPP
+
+//
+// coroutine.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+//
+// The rest of Ren-C++ is C++11, so this header is not included by ren.hpp.
+// It is only usable by clients compiling as C++20 (or with a compiler that
+// provides coroutines as an extension under an earlier standard).
+//
+
+#if !defined(__cpp_impl_coroutine)
+    #error "%coroutine.hpp needs a compiler with C++20 coroutine support"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "ren.hpp"
+#include "executor.hpp"
+
+
+namespace ren {
+
+
+//
+// AWAITABLE EVALUATIONS
+//
+
+//
+// `runtime(...)` blocks the calling thread until the evaluation finishes.
+// A server handling many requests on a few I/O threads would have to give
+// each in-flight script its own blocked thread.  With coroutines, the I/O
+// thread can instead suspend just the request:
+//
+//     Task handle(Record rec) {
+//         auto result = co_await ren::async("process-record", rec);
+//         ...
+//         auto other = co_await someFunction.callAsync(1, 2);
+//     }
+//
+// The evaluation is submitted to an Executor (which serializes it with all
+// other use of the engine via the EvaluatorLock).  When it's done, the
+// coroutine is handed to the scheduler to be resumed.  Load and evaluation
+// errors are rethrown from the `co_await` expression, just as `runtime(...)`
+// would throw them.
+//
+// The scheduler is whatever the server uses to get work back onto its own
+// threads, e.g. posting to an asio::io_context.  Without one, the coroutine
+// is resumed right on the executor thread, with the lock released.
+//
+// The usual threading rules still apply: the arguments are copied when the
+// awaitable is made, and the optional<AnyValue> that comes back is an engine
+// value.  If other threads may be evaluating, take an EvaluatorLock around
+// code that makes, uses, or destroys values.
+//
+
+using Scheduler = std::function<void(std::coroutine_handle<>)>;
+
+
+namespace internal {
+
+struct AsyncSettings {
+    std::mutex mutex;
+    Executor * executor = nullptr;
+    std::unique_ptr<Executor> ownExecutor; // made on demand if none set
+    Scheduler scheduler;
+
+    static AsyncSettings & get() {
+        static AsyncSettings settings;
+        return settings;
+    }
+};
+
+} // end namespace internal
+
+
+// Set the executor awaitable evaluations run on, and how the coroutines are
+// resumed.  The executor must outlive any evaluations in flight.
+//
+inline void setAsyncExecutor(
+    Executor & executor,
+    Scheduler scheduler = nullptr
+) {
+    auto & settings = internal::AsyncSettings::get();
+    std::lock_guard<std::mutex> lock (settings.mutex);
+    settings.executor = &executor;
+    settings.scheduler = std::move(scheduler);
+}
+
+
+class Evaluation {
+private:
+    struct State {
+        optional<AnyValue> result;
+        std::exception_ptr error;
+    };
+
+    Executor::Job job;
+    std::shared_ptr<State> state;
+
+public:
+    explicit Evaluation (Executor::Job job) :
+        job (std::move(job)),
+        state (std::make_shared<State>())
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> awaiting) {
+        auto & settings = internal::AsyncSettings::get();
+
+        Executor * executor;
+        Scheduler scheduler;
+        {
+            std::lock_guard<std::mutex> lock (settings.mutex);
+            if (!settings.executor) {
+                settings.ownExecutor.reset(new Executor {1});
+                settings.executor = settings.ownExecutor.get();
+            }
+            executor = settings.executor;
+            scheduler = settings.scheduler;
+        }
+
+        // The executor's future is not used; the outcome goes into the
+        // shared state instead.  Resumption is done by the executor's `then`
+        // step, because the coroutine's code must not run while that thread
+        // holds the evaluator lock.
+
+        // (The job is moved rather than copied in, so that any values it
+        // captured are only destroyed on the executor thread, under the lock.)
+
+        executor->submit(
+            [work = std::move(job), shared = state]() -> optional<AnyValue> {
+                try {
+                    shared->result = work();
+                }
+                catch (...) {
+                    shared->error = std::current_exception();
+                }
+                return nullopt;
+            },
+            [scheduler, awaiting]() {
+                if (scheduler)
+                    scheduler(awaiting);
+                else
+                    awaiting.resume();
+            }
+        );
+    }
+
+    optional<AnyValue> await_resume() {
+        if (state->error)
+            std::rethrow_exception(state->error);
+        return std::move(state->result);
+    }
+};
+
+
+//
+// `co_await async(args...)` is the awaitable form of `runtime(args...)`.
+//
+template <typename... Ts>
+Evaluation async(Ts &&... args) {
+    return Evaluation {
+        [...args = std::forward<Ts>(args)]() -> optional<AnyValue> {
+            return runtime(args...);
+        }
+    };
+}
+
+
+template <typename... Ts>
+Evaluation Function::callAsync(Ts &&... args) const {
+    return Evaluation {
+        [self = *this, ...args = std::forward<Ts>(args)]()
+            -> optional<AnyValue>
+        {
+            return self(args...);
+        }
+    };
+}
+
+} // end namespace ren
+
+#endif
@@ -66,6 +66,12 @@ private:
 
     static Finder finder;
 
+    friend class EngineScope;
+    static thread_local Engine * scoped; // innermost EngineScope, if any
+    static thread_local Engine * cachedGlobal;
+
+    static Engine & global();
+
     // These should maybe be internalized behind the binding and not data
     // members of the C++ class
 private:
@@ -93,6 +99,9 @@ public:
         return handle;
     }
 
+    // An empty Finder means the default engine, and is what you get back
+    // from the first call (so it can be passed back in to restore it).
+    //
     static Finder setFinder(
         Finder const & newFinder
     ) {
@@ -101,15 +110,21 @@ public:
         return result;
     }
 
+    // Engine lookup happens for nearly every value constructed, so the
+    // common cases avoid the std::function call.  An EngineScope on this
+    // thread wins, then any finder that was set, and otherwise it's the
+    // default engine (cached per thread to skip the static's guard).
+    //
     static Engine & runFinder() {
-        if (finder == nullptr) {
-            finder = [] () -> Engine & {
-                static Engine global;
-                return global;
-            };
-        }
+        if (scoped != nullptr)
+            return *scoped;
+
+        if (finder != nullptr)
+            return finder();
 
-        return finder();
+        if (cachedGlobal == nullptr)
+            cachedGlobal = &global();
+        return *cachedGlobal;
     }
 
 
@@ -163,6 +178,43 @@ public:
     }
 };
 
+
+
+//
+// SCOPED ENGINE OVERRIDE
+//
+
+//
+// Makes `engine` the one that Engine::runFinder() gives back on this thread
+// for the lifetime of the scope, without going through the finder.  Scopes
+// may be nested, and each one restores what was in effect before it.
+//
+//     Engine sandbox;
+//     {
+//         EngineScope scope {sandbox};
+//         Integer i {10}; // made in the sandbox engine
+//     }
+//
+
+class EngineScope {
+private:
+    Engine * previous;
+
+public:
+    explicit EngineScope (Engine & engine) :
+        previous (Engine::scoped)
+    {
+        Engine::scoped = &engine;
+    }
+
+    EngineScope (EngineScope const &) = delete;
+    EngineScope & operator=(EngineScope const &) = delete;
+
+    ~EngineScope () {
+        Engine::scoped = previous;
+    }
+};
+
 } // end namespace ren
 
 #endif
@@ -0,0 +1,193 @@
+#ifndef RENCPP_EXECUTOR_HPP
+#define RENCPP_EXECUTOR_HPP
+
+//
+// executor.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "value.hpp"
+
+
+namespace ren {
+
+
+//
+// EVALUATOR LOCK
+//
+
+//
+// The interpreter has one data stack, one frame stack, and one chain of
+// trap states.  None of that can be touched by two threads at once, so when
+// several threads want to evaluate they have to take turns.  This is the
+// same arrangement as Python's "GIL": whoever holds the EvaluatorLock may
+// create, copy, and destroy ren:: values and call into the runtime.
+//
+// A program which only ever uses the engine from one thread never needs to
+// take the lock.  It's for when an Executor (below) or other threads are in
+// the picture, in which case every thread touching the engine must hold it.
+// Note that includes *destroying* values, e.g. the optional<AnyValue> that
+// comes back through an Executor's future.
+//
+// The lock is not recursive.
+//
+
+class EvaluatorLock {
+public:
+    EvaluatorLock ();
+    ~EvaluatorLock ();
+
+    EvaluatorLock (EvaluatorLock const & other) = delete;
+    EvaluatorLock & operator= (EvaluatorLock const & other) = delete;
+
+    static bool isHeld(); // ...by the calling thread
+};
+
+
+
+//
+// RELEASING THE LOCK INSIDE A NATIVE
+//
+
+//
+// A native written with Function::construct that spends seconds doing pure
+// C++ work (I/O, compression, numerics) would otherwise keep every other
+// thread out of the engine.  Putting an Unlocked on the stack gives up the
+// EvaluatorLock for its scope:
+//
+//     auto transform = Function::construct(
+//         "text [string!]",
+//         [](String const & text) -> String {
+//             std::string bytes = to_string(text);
+//             {
+//                 Unlocked unlocked; // no ren:: values in this scope!
+//                 bytes = slowTransform(bytes);
+//             }
+//             return String {bytes};
+//         }
+//     );
+//
+// While the native is suspended, other threads may run evaluations.  Those
+// evaluations push their frames on top of the suspended one, so resuming
+// has to wait until they have all unwound back to it: reacquisition is in
+// LIFO order, and the destructor blocks until both the lock is free *and*
+// the top frame is the one that was suspended.  (Threads waiting to resume
+// are given priority over new evaluations, so they are not starved.)
+//
+// The C stack limit used for overflow detection is per-thread, and is put
+// back to the suspended thread's value on resumption.
+//
+// Unlocked is a no-op when no thread holds the EvaluatorLock, so natives can
+// use it unconditionally and still work in single-threaded programs.  Debug
+// builds assert if values are made inside the scope, or if the native is
+// running on a thread other than the one holding the lock.
+//
+
+class Unlocked {
+public:
+    Unlocked ();
+    ~Unlocked ();
+
+    Unlocked (Unlocked const & other) = delete;
+    Unlocked & operator= (Unlocked const & other) = delete;
+
+    static bool isActiveOnThisThread();
+
+private:
+    bool active;
+    void * frame; // Reb_Frame * of the suspended native
+    void * stackLimit;
+};
+
+
+
+//
+// EXECUTOR
+//
+
+//
+// A queue of evaluations and a set of threads to run them.  Each job runs
+// holding the EvaluatorLock, so interpretation stays serialized, but while
+// one job is inside an Unlocked section another thread can take the next
+// job.  Results and exceptions come back through a std::future.
+//
+// The submitted callable may do anything a thread holding the lock may do.
+// For convenience, submitting a string runs it as source in the runtime.
+//
+
+class Executor {
+public:
+    using Job = std::function<optional<AnyValue>()>;
+
+    explicit Executor (size_t numThreads = 1);
+
+    Executor (Executor const & other) = delete;
+    Executor & operator= (Executor const & other) = delete;
+
+    std::future<optional<AnyValue>> submit(Job job);
+
+    std::future<optional<AnyValue>> submit(std::string const & source);
+
+    std::future<optional<AnyValue>> submit(char const * source) {
+        return submit(std::string {source});
+    }
+
+    // `then` is run on the executor thread after the job, once the evaluator
+    // lock has been released.  So it may not use values, but it may block or
+    // resume other work (e.g. a suspended coroutine).
+    //
+    std::future<optional<AnyValue>> submit(
+        Job job,
+        std::function<void()> then
+    );
+
+    size_t pending() const;
+
+    // Finishes queued jobs, then joins the threads.  Submitting after close
+    // throws std::runtime_error.  Don't close (or destroy) an Executor while
+    // holding the EvaluatorLock, as its threads need the lock to finish.
+    //
+    void close();
+
+    ~Executor ();
+
+private:
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    struct Entry {
+        std::packaged_task<optional<AnyValue>()> task;
+        std::function<void()> then;
+    };
+
+    std::deque<Entry> queue;
+    std::vector<std::thread> threads;
+    bool closing;
+};
+
+} // end namespace ren
+
+#endif
@@ -92,6 +92,10 @@
 
 namespace ren {
 
+#if defined(__cpp_impl_coroutine)
+    class Evaluation; // awaitable, see %coroutine.hpp
+#endif
+
 namespace internal {
 
 //
@@ -362,6 +366,14 @@ public:
     inline optional<AnyValue> operator()(Ts &&... args) const {
         return apply(std::forward<Ts>(args)...);
     }
+
+#if defined(__cpp_impl_coroutine)
+    // `co_await fn.callAsync(args...)` runs the call on the async executor.
+    // Defined in %coroutine.hpp, which must be included to use it.
+    //
+    template <typename... Ts>
+    Evaluation callAsync(Ts &&... args) const;
+#endif
 };
 
 
@@ -399,6 +411,11 @@ private:
 
     using ParamsType = std::tuple<Ts...>;
 
+    template <std::size_t Index>
+    using ArgCell = typename ArgumentCell<
+        typename std::decay<typename utility::type_at<Index, Ts...>::type>::type
+    >::type;
+
     // Function used to create Ts... on the fly and apply a
     // given function to them
 
@@ -411,11 +428,7 @@ private:
     )
         -> decltype(
             cppfun(
-                AnyValue::fromCell_<
-                    typename std::decay<
-                        typename utility::type_at<Indices, Ts...>::type
-                    >::type
-                >(
+                AnyValue::fromCell_<ArgCell<Indices>>(
                     RL_Arg(f, Indices + 1), // Indices are 0-based
                     engine
                 )...
@@ -423,11 +436,7 @@ private:
         )
     {
         return cppfun(
-            AnyValue::fromCell_<
-                typename std::decay<
-                    typename utility::type_at<Indices, Ts...>::type
-                >::type
-            >(
+            AnyValue::fromCell_<ArgCell<Indices>>(
                 RL_Arg(f, Indices + 1), // Indices are 0 based
                 engine
             )...
@@ -0,0 +1,218 @@
+#ifndef RENCPP_PARALLEL_HPP
+#define RENCPP_PARALLEL_HPP
+
+//
+// parallel.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "arrays.hpp"
+#include "executor.hpp"
+
+
+namespace ren {
+
+
+//
+// PARALLEL MAP OVER ARRAY ELEMENTS
+//
+
+//
+// Nothing in the runtime may be touched from more than one thread, but a
+// transformation that is pure C++ over numbers or strings doesn't need the
+// runtime at all.  So parallelMap() pulls the elements out of the array into
+// a std::vector in one pass, runs the callable over them on a thread pool,
+// and then builds a new block from the results in one pass:
+//
+//     Block squares = parallelMap(numbers, [](double x) { return x * x; });
+//
+// The element type is taken from the callable's parameter:
+//
+// * integral types take INTEGER! elements (in the type's range)
+// * floating point types take DECIMAL! or INTEGER! elements
+// * std::string takes any string type (e.g. STRING!, FILE!, TAG!) as UTF-8
+//
+// The result type is mapped the same way, to INTEGER!, DECIMAL!, or STRING!.
+// (bool is rejected at compile time either way, since it's neither an
+// INTEGER! nor a number for the callable.)  An element of the wrong type
+// raises a bad_value_cast before any work is started.  An unsigned result
+// too big for an INTEGER!, or a string result that isn't valid UTF-8, is
+// an error too.  If the callable throws, the first exception is rethrown
+// once the other threads have stopped.
+//
+// The callable is run with the evaluator lock released (see ren::Unlocked),
+// so it may not use ren:: values, and other Executor threads can evaluate
+// while it runs.  `numThreads` of 0 means the whole pool.
+//
+// To make a callable available to Rebol code as `parallel-map data 'name`,
+// register it with registerParallelKernel(name, fn).
+//
+
+namespace internal {
+
+template <class T>
+using ParallelStorage = typename std::conditional<
+    std::is_integral<T>::value,
+    int64_t,
+    typename std::conditional<
+        std::is_floating_point<T>::value,
+        double,
+        std::string
+    >::type
+>::type;
+
+
+// Integral elements are extracted as int64_t, so a callable taking a smaller
+// integer type would get them truncated.  Instead an element out of its
+// range is a bad_value_cast, before any work is started.  Results go the
+// other way, and an unsigned one past the top of int64_t throws as well.
+// Offsets in the messages count from 0, as AnyArray::extract()'s do.
+
+template <class T, bool = std::is_integral<T>::value>
+struct ParallelRangeCheck {
+    static void check(std::vector<ParallelStorage<T>> const &) {}
+
+    template <class U>
+    static U && result(U && value, size_t) { return std::forward<U>(value); }
+};
+
+template <class T>
+struct ParallelRangeCheck<T, true> {
+    static bool fits(int64_t value, std::true_type) { // unsigned
+        return value >= 0 && static_cast<uint64_t>(value)
+            <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+    }
+
+    static bool fits(int64_t value, std::false_type) { // signed
+        return value >= static_cast<int64_t>(std::numeric_limits<T>::min())
+            && value <= static_cast<int64_t>(std::numeric_limits<T>::max());
+    }
+
+    static void check(std::vector<int64_t> const & inputs) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (!fits(inputs[i], std::is_unsigned<T>{}))
+                throw bad_value_cast(
+                    "parallelMap() element at offset " + std::to_string(i)
+                    + " is out of range of the callable's integer type"
+                );
+        }
+    }
+
+    static int64_t result(T value, size_t i) {
+        if (
+            std::is_unsigned<T>::value
+            && static_cast<uint64_t>(value)
+                > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())
+        ){
+            throw bad_value_cast(
+                "parallelMap() result at offset " + std::to_string(i)
+                + " is out of range of INTEGER!"
+            );
+        }
+        return static_cast<int64_t>(value);
+    }
+};
+
+
+class ParallelMapper {
+public:
+    // Runs the kernel registered under `name` on the array in `series`, for
+    // the PARALLEL-MAP native
+    //
+    static void applyKernel(
+        REBVAL * out,
+        REBVAL const * series,
+        std::string const & name
+    );
+};
+
+
+//
+// Calls `body(begin, end)` over subranges of [0, count) on the shared pool.
+// Each thread starts on its own slice, and steals chunks of the others'
+// slices when it runs out.
+//
+void parallelFor(
+    size_t count,
+    std::function<void(size_t begin, size_t end)> const & body,
+    size_t numThreads = 0
+);
+
+
+using ParallelKernel = std::function<Block(AnyArray const & array)>;
+
+void registerParallelKernel(std::string const & name, ParallelKernel kernel);
+
+} // end namespace internal
+
+
+
+template <class F>
+Block parallelMap(AnyArray const & array, F fn, size_t numThreads = 0) {
+    using In = typename std::decay<utility::argument_type<F, 0>>::type;
+    using Out = typename std::decay<utility::result_type<F>>::type;
+
+    static_assert(
+        !std::is_same<In, bool>::value && !std::is_same<Out, bool>::value,
+        "parallelMap() callables take and give numbers or std::string,"
+        " not bool"
+    );
+
+    std::vector<internal::ParallelStorage<In>> inputs;
+    array.extract(inputs);
+    internal::ParallelRangeCheck<In>::check(inputs);
+
+    std::vector<internal::ParallelStorage<Out>> outputs (inputs.size());
+
+    {
+        Unlocked unlocked;
+
+        internal::parallelFor(
+            inputs.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                    outputs[i] = internal::ParallelRangeCheck<Out>::result(
+                        fn(static_cast<In const &>(inputs[i])), i
+                    );
+            },
+            numThreads
+        );
+    }
+
+    return Block::from(outputs);
+}
+
+
+template <class F>
+void registerParallelKernel(std::string const & name, F fn) {
+    internal::registerParallelKernel(
+        name,
+        [fn](AnyArray const & array) -> Block {
+            return parallelMap(array, fn);
+        }
+    );
+}
+
+} // end namespace ren
+
+#endif
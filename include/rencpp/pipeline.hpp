@@ -0,0 +1,477 @@
+#ifndef RENCPP_PIPELINE_HPP
+#define RENCPP_PIPELINE_HPP
+
+//
+// pipeline.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "arrays.hpp"
+#include "function.hpp"
+#include "executor.hpp"
+
+
+namespace ren {
+
+
+//
+// STREAMING RECORD PIPELINE
+//
+
+//
+// The usual shape of an ETL job around the interpreter: C++ threads produce
+// records, a Rebol function transforms them, and C++ threads consume what
+// comes out.  Because only one thread at a time may evaluate, the transform
+// is a single stage, and it's much cheaper to call it once per batch than
+// once per record:
+//
+//     Pipeline<Order, Invoice> pipeline {
+//         static_cast<Function>(*runtime(":price-orders")), // takes a block
+//         [](Order const & o) -> AnyValue { return Block {o.sku, o.qty}; },
+//         [](AnyValue const & v) -> Invoice { return toInvoice(v); },
+//         [](Invoice invoice) { ledger.post(invoice); }
+//     };
+//
+//     pipeline.push(order); // from any number of producer threads
+//     ...
+//     pipeline.close(); // drains everything, then joins
+//
+// The function is passed a block with one encoded value per record, and
+// must return a block with one result per record, in the same order.  The
+// encoder and decoder run on the transform thread holding the EvaluatorLock,
+// so producers and consumers only ever see C++ types and never need it.
+//
+// * Backpressure: push() blocks while `capacity` records are waiting for the
+//   transform, and the transform waits if `capacity` results are waiting for
+//   the consumers.  (tryPush() returns false instead of blocking.)
+//
+// * Batch size tuning: the batch grows (doubling, up to maxBatch) while
+//   batches finish well under `targetBatchTime` and there's a backlog, and
+//   halves (down to minBatch) when they run over.  This trades latency for
+//   throughput only when the input rate calls for it.
+//
+// * Counters: stats() gives the record counts, current batch size, queue
+//   depths, and the mean transform time per batch and push-to-consume
+//   latency per record.
+//
+// If a batch fails (a Rebol error, or a result block of the wrong length),
+// its records are dropped and counted, and the error handler if any is
+// called with the exception.  It runs on the transform thread without the
+// EvaluatorLock held, so it must take the lock itself to use any values in
+// the exception (an evaluation_error holds the Error).  An exception thrown
+// by the handler is written to std::cerr and otherwise ignored.
+//
+// !!! The Function is a value like any other: if other threads may be
+// evaluating, hold the EvaluatorLock when making and destroying a Pipeline.
+// Don't close() or destroy one while holding the lock, as the transform
+// stage needs it to finish.
+//
+
+struct PipelineOptions {
+    size_t capacity = 4096;
+    size_t minBatch = 16;
+    size_t maxBatch = 1024;
+    std::chrono::microseconds targetBatchTime {5000};
+    size_t consumers = 1;
+};
+
+
+struct PipelineStats {
+    uint64_t pushed;
+    uint64_t delivered;
+    uint64_t dropped; // records in failed batches
+    uint64_t batches;
+    uint64_t failedBatches;
+    uint64_t consumerErrors; // exceptions thrown by the consumer
+
+    size_t batchSize;
+    size_t inputQueued;
+    size_t outputQueued;
+
+    double meanBatchMicros;
+    double meanLatencyMicros;
+};
+
+
+template <class In, class Out>
+class Pipeline {
+    static_assert(
+        !std::is_base_of<AnyValue, In>::value
+        && !std::is_base_of<AnyValue, Out>::value,
+        "Pipeline records are plain C++ types; producers and consumers run"
+        " without the EvaluatorLock"
+    );
+
+public:
+    using Encoder = std::function<AnyValue(In const &)>;
+    using Decoder = std::function<Out(AnyValue const &)>;
+    using Consumer = std::function<void(Out)>;
+    using ErrorHandler = std::function<void(std::exception_ptr, size_t count)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    template <class T>
+    struct Stamped {
+        T record;
+        Clock::time_point pushed;
+    };
+
+    Function transform;
+    Encoder encode;
+    Decoder decode;
+    Consumer consume;
+    ErrorHandler onError;
+    PipelineOptions options;
+
+    mutable std::mutex mutex;
+    std::condition_variable inputReady;
+    std::condition_variable inputSpace;
+    std::condition_variable outputReady;
+    std::condition_variable outputSpace;
+
+    std::deque<Stamped<In>> input;
+    std::deque<Stamped<Out>> output;
+    bool closingInput;
+    bool closingOutput;
+    bool closed;
+
+    size_t batchSize;
+    PipelineStats counters;
+    double totalBatchMicros;
+    double totalLatencyMicros;
+
+    std::thread transformThread;
+    std::vector<std::thread> consumerThreads;
+
+public:
+    Pipeline (
+        Function const & transform,
+        Encoder encode,
+        Decoder decode,
+        Consumer consume,
+        PipelineOptions const & options = PipelineOptions {},
+        ErrorHandler onError = nullptr
+    ) :
+        transform (transform),
+        encode (std::move(encode)),
+        decode (std::move(decode)),
+        consume (std::move(consume)),
+        onError (std::move(onError)),
+        options (options),
+        closingInput (false),
+        closingOutput (false),
+        closed (false),
+        batchSize (options.minBatch),
+        counters (),
+        totalBatchMicros (0),
+        totalLatencyMicros (0)
+    {
+        if (
+            options.capacity == 0 || options.minBatch == 0
+            || options.maxBatch < options.minBatch || options.consumers == 0
+        ){
+            throw std::invalid_argument("Bad PipelineOptions");
+        }
+
+        transformThread = std::thread {&Pipeline::runTransform, this};
+        for (size_t n = 0; n < options.consumers; ++n)
+            consumerThreads.emplace_back(&Pipeline::runConsumer, this);
+    }
+
+    Pipeline (Pipeline const &) = delete;
+    Pipeline & operator=(Pipeline const &) = delete;
+
+
+    // Blocks while the input is full.  Throws std::runtime_error if the
+    // pipeline has been closed.
+    //
+    void push(In record) {
+        std::unique_lock<std::mutex> guard (mutex);
+        inputSpace.wait(guard, [&]() -> bool {
+            return closingInput || input.size() < options.capacity;
+        });
+        enqueue(std::move(record));
+        guard.unlock();
+        inputReady.notify_one();
+    }
+
+    bool tryPush(In record) {
+        std::unique_lock<std::mutex> guard (mutex);
+        if (!closingInput && input.size() >= options.capacity)
+            return false;
+        enqueue(std::move(record));
+        guard.unlock();
+        inputReady.notify_one();
+        return true;
+    }
+
+
+    // Stops accepting records, lets everything pushed so far go through the
+    // transform and the consumers, and joins the threads.
+    //
+    void close() {
+        assert(!EvaluatorLock::isHeld()); // the transform would wait forever
+
+        {
+            std::lock_guard<std::mutex> guard (mutex);
+            if (closed)
+                return;
+            closed = true;
+            closingInput = true;
+        }
+        inputReady.notify_all();
+        inputSpace.notify_all();
+        transformThread.join();
+
+        {
+            std::lock_guard<std::mutex> guard (mutex);
+            closingOutput = true;
+        }
+        outputReady.notify_all();
+        for (auto & thread : consumerThreads)
+            thread.join();
+    }
+
+
+    PipelineStats stats() const {
+        std::lock_guard<std::mutex> guard (mutex);
+        PipelineStats result = counters;
+        result.batchSize = batchSize;
+        result.inputQueued = input.size();
+        result.outputQueued = output.size();
+        result.meanBatchMicros = counters.batches == 0
+            ? 0
+            : totalBatchMicros / static_cast<double>(counters.batches);
+        result.meanLatencyMicros = counters.delivered == 0
+            ? 0
+            : totalLatencyMicros / static_cast<double>(counters.delivered);
+        return result;
+    }
+
+
+    ~Pipeline () {
+        close();
+    }
+
+
+private:
+    void enqueue(In && record) { // mutex must be held
+        if (closingInput)
+            throw std::runtime_error("Pipeline has been closed");
+        input.push_back(Stamped<In> {std::move(record), Clock::now()});
+        ++counters.pushed;
+    }
+
+
+    // Runs holding the EvaluatorLock.  All values made here are gone by the
+    // time it returns, except inside a thrown exception.
+    //
+    std::vector<Out> transformBatch(std::vector<Stamped<In>> const & batch) {
+        std::vector<AnyValue> encoded;
+        encoded.reserve(batch.size());
+        for (auto const & item : batch)
+            encoded.push_back(encode(item.record));
+
+        optional<AnyValue> result = transform(Block::from(encoded));
+
+        if (!hasType<AnyArray>(result))
+            throw std::runtime_error("Pipeline transform must return a block");
+
+        AnyArray results = static_cast<AnyArray>(*result);
+        if (results.length() != batch.size())
+            throw std::runtime_error(
+                "Pipeline transform must return one result per record"
+            );
+
+        std::vector<Out> decoded;
+        decoded.reserve(batch.size());
+        for (AnyValue item : results)
+            decoded.push_back(decode(item));
+        return decoded;
+    }
+
+
+    // The handler is called without the EvaluatorLock, so a handler that
+    // blocks or takes a lock of its own can't stall other evaluation.  If it
+    // throws, there's no one on this thread to catch it, so the exception is
+    // reported and swallowed.
+    //
+    void reportError(std::exception_ptr const & error, size_t count) {
+        if (!onError)
+            return;
+
+        try {
+            onError(error, count);
+        }
+        catch (std::exception const & e) {
+            std::cerr << "Pipeline error handler threw: " << e.what() << "\n";
+        }
+        catch (...) {
+            std::cerr << "Pipeline error handler threw\n";
+        }
+    }
+
+
+    void runTransform() {
+        std::vector<Stamped<In>> batch;
+
+        while (true) {
+            size_t wanted;
+            {
+                std::unique_lock<std::mutex> guard (mutex);
+                inputReady.wait(guard, [&]() -> bool {
+                    return closingInput || !input.empty();
+                });
+                if (input.empty())
+                    return; // closing, and everything has been taken
+
+                wanted = batchSize;
+                size_t count = std::min(wanted, input.size());
+                auto end = input.begin() + static_cast<std::ptrdiff_t>(count);
+                batch.assign(
+                    std::make_move_iterator(input.begin()),
+                    std::make_move_iterator(end)
+                );
+                input.erase(input.begin(), end);
+            }
+            inputSpace.notify_all();
+
+            Clock::time_point start = Clock::now();
+
+            std::vector<Out> decoded;
+            std::exception_ptr error;
+            {
+                EvaluatorLock lock;
+                try {
+                    decoded = transformBatch(batch);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            bool failed = error != nullptr;
+
+            if (failed) {
+                reportError(error, batch.size());
+
+                EvaluatorLock lock; // the exception may hold values
+                error = nullptr;
+            }
+
+            double micros = std::chrono::duration<double, std::micro>(
+                Clock::now() - start
+            ).count();
+
+            std::unique_lock<std::mutex> guard (mutex);
+
+            ++counters.batches;
+            totalBatchMicros += micros;
+
+            double target = static_cast<double>(
+                options.targetBatchTime.count()
+            );
+            if (micros > target)
+                batchSize = std::max(options.minBatch, batchSize / 2);
+            else if (
+                micros < target / 2
+                && batch.size() == wanted
+                && !input.empty()
+            ){
+                batchSize = std::min(options.maxBatch, batchSize * 2);
+            }
+
+            if (failed) {
+                ++counters.failedBatches;
+                counters.dropped += batch.size();
+                continue;
+            }
+
+            for (size_t n = 0; n < decoded.size(); ++n) {
+                outputSpace.wait(guard, [&]() -> bool {
+                    return output.size() < options.capacity;
+                });
+                output.push_back(
+                    Stamped<Out> {std::move(decoded[n]), batch[n].pushed}
+                );
+                outputReady.notify_one();
+            }
+        }
+    }
+
+
+    void runConsumer() {
+        // (A vector, so that Out needn't be default-constructible)
+        //
+        std::vector<Stamped<Out>> taken;
+
+        while (true) {
+            taken.clear();
+            {
+                std::unique_lock<std::mutex> guard (mutex);
+                outputReady.wait(guard, [&]() -> bool {
+                    return closingOutput || !output.empty();
+                });
+                if (output.empty())
+                    return; // closing, and everything has been consumed
+
+                taken.push_back(std::move(output.front()));
+                output.pop_front();
+            }
+            outputSpace.notify_one();
+
+            Stamped<Out> & item = taken.front();
+
+            bool ok = true;
+            try {
+                consume(std::move(item.record));
+            }
+            catch (...) {
+                ok = false;
+            }
+
+            double micros = std::chrono::duration<double, std::micro>(
+                Clock::now() - item.pushed
+            ).count();
+
+            std::lock_guard<std::mutex> guard (mutex);
+            ++counters.delivered;
+            totalLatencyMicros += micros;
+            if (!ok)
+                ++counters.consumerErrors;
+        }
+    }
+};
+
+} // end namespace ren
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef RENCPP_POOL_HPP
+#define RENCPP_POOL_HPP
+
+//
+// pool.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+
+
+namespace ren {
+
+
+//
+// POOL OF PRE-FORKED ENGINES
+//
+
+//
+// Rebol has no memory isolation between interpreter instances, so the hooks
+// refuse to allocate more than one Engine per process (see AllocEngine in
+// %hooks.cpp).  That means a single process can only use one core for
+// interpretation.  Rather than rewrite the runtime, the EnginePool gets its
+// parallelism from the operating system: it boots the engine, runs whatever
+// startup code the client gives it, and then uses `fork()` to make "warm"
+// worker processes that share the boot pages copy-on-write.
+//
+// The fork is not done from the calling process directly.  A multithreaded
+// process that forks only takes the forking thread into the child, along
+// with any mutexes other threads happened to be holding.  So the pool forks
+// exactly once at construction into a single-threaded "zygote", which never
+// evaluates anything itself.  When a worker is needed (initially, or to
+// replace one that crashed) the zygote forks it and passes the socket for
+// talking to it back over a UNIX domain socket.
+//
+// Requests are UTF-8 source text, and results come back MOLDed.  This means
+// values only survive the trip if MOLD can represent them (functions and
+// objects with cycles, for instance, cannot).  The text protocol is the same
+// thing a client would get from `to_string()` on one side and a Loadable on
+// the other...it just runs on N cores.  A request or result can't be larger
+// than 4 GiB; a request that is throws, and a result that is comes back as
+// an error.
+//
+// Workers are reused, and are NOT reset between requests.  Anything a
+// request does to global state--setting words in the user context, changing
+// system settings, loading code--is still there for the next request that
+// happens to go to the same worker.  Which worker that is isn't predictable,
+// so requests should not depend on each other.  Only a worker that died is
+// replaced with a fresh fork of the startup state.  If a worker is found to
+// have died while idle (the request couldn't be sent), the request is sent
+// once more, to its replacement.
+//
+// !!! Only POSIX platforms are supported; constructing an EnginePool on
+// Windows throws.  Also note that the pool must be constructed before the
+// process starts any threads that use the engine, since that first fork is
+// taken from the calling thread.
+//
+
+class EnginePool {
+public:
+    // Disable copy construction and assignment.
+
+    EnginePool (EnginePool const & other) = delete;
+    EnginePool & operator= (EnginePool const & other) = delete;
+
+public:
+    explicit EnginePool (
+        size_t numWorkers,
+        char const * startupCode = nullptr
+    );
+
+    size_t size() const { return workers.size(); }
+
+    // How many workers have been replaced after dying mid-request (or while
+    // idle, if the death was noticed at dispatch time)
+    //
+    size_t restarts() const;
+
+
+    //
+    // This is safe to call from any thread, and blocks until a worker is
+    // idle and then until that worker responds.  What comes back is the
+    // MOLDed result, or nullopt if the evaluation produced no value.  A
+    // failure in the worker throws a std::runtime_error carrying the FORMed
+    // error message (the text is all that made it across the process).
+    //
+    optional<std::string> evaluateMolded(std::string const & source);
+
+    //
+    // This variant loads the molded result into the local engine, and
+    // converts worker failures into the usual load_error/evaluation_error.
+    // Because it touches the local engine, it has the same threading rules
+    // as any other use of ren:: values.
+    //
+    optional<AnyValue> evaluate(std::string const & source);
+
+
+    //
+    // See notes on how close() is used for catching exceptions, while the
+    // destructor should not throw:
+    //
+    //     http://stackoverflow.com/a/130123/211160
+    //
+    void close();
+
+    ~EnginePool ();
+
+
+private:
+    // Status byte which precedes the payload in a worker's response
+
+    enum class Status : unsigned char {
+        Value,
+        NoValue,
+        LoadError,
+        EvaluationError,
+        OtherError
+    };
+
+    struct Worker {
+        int fd;
+        bool busy;
+    };
+
+    std::vector<Worker> workers;
+    size_t numRestarts;
+
+    int zygoteFd;
+    long zygotePid; // pid_t is not available in a portable header
+
+    mutable std::mutex mutex;
+    std::condition_variable idle;
+
+    int spawnWorker(); // caller must hold the mutex
+
+    Status transact(
+        std::string const & source,
+        std::string & payloadOut
+    );
+
+    [[noreturn]] static void runZygote(int controlFd);
+
+    [[noreturn]] static void runWorker(int fd);
+
+    static std::string moldAsUtf8(AnyValue const & value);
+};
+
+} // end namespace ren
+
+#endif
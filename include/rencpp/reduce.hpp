@@ -0,0 +1,114 @@
+#ifndef RENCPP_REDUCE_HPP
+#define RENCPP_REDUCE_HPP
+
+//
+// reduce.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstdint>
+#include <vector>
+
+#include "value.hpp"
+#include "arrays.hpp"
+
+
+namespace ren {
+
+
+//
+// NUMERIC REDUCTIONS
+//
+
+//
+// Totals and statistics over an array of numbers, from its position to its
+// tail, without making a value for each element.  The elements are checked
+// in one pass first, then copied out of their cells a chunk at a time into
+// plain buffers for the arithmetic (with SSE2 where it's available, see
+// %reduce.cpp):
+//
+//     Block latencies = static_cast<Block>(*runtime("load %latencies.r"));
+//     double average = mean(latencies);
+//
+// Elements must be INTEGER! or DECIMAL!, else a bad_value_cast says which
+// one wasn't.  If they're all integers the sum, extremes, dot product, and
+// prefix sums are integers (and overflow throws std::overflow_error), and
+// if any are decimals those are decimals.  The mean and variance are always
+// decimals.
+//
+// Decimals are summed in several lanes at once, so the result may differ in
+// the last bits from adding them up in order.
+//
+// The same are natives for Ren code: SUM-OF, MIN-OF, MAX-OF, MEAN-OF,
+// VARIANCE-OF, DOT-PRODUCT, PREFIX-SUM, and HISTOGRAM.
+//
+
+AnyValue sum(AnyArray const & numbers);
+
+// nullopt if the array is empty
+//
+optional<AnyValue> minimum(AnyArray const & numbers);
+optional<AnyValue> maximum(AnyArray const & numbers);
+
+// Throw std::domain_error if the array is empty (or, for the sample
+// variance, has fewer than two numbers)
+//
+double mean(AnyArray const & numbers);
+double variance(AnyArray const & numbers, bool sample = false);
+
+// The arrays must be the same length
+//
+AnyValue dot(AnyArray const & left, AnyArray const & right);
+
+// A new block whose nth element is the sum of the first n numbers
+//
+Block prefixSum(AnyArray const & numbers);
+
+// Counts of the numbers in each of `buckets` equal divisions of the range
+// from `low` to `high`.  The range includes `high` (in the last bucket);
+// numbers outside it aren't counted.
+//
+std::vector<int64_t> histogram(
+    AnyArray const & numbers,
+    double low,
+    double high,
+    size_t buckets
+);
+
+
+namespace internal {
+
+class Reduction {
+public:
+    static REBVAL const * cellOf(AnyValue const & value) {
+        return value.cell;
+    }
+
+    template <class T>
+    static T fromCell(REBVAL const * cell, AnyValue const & source) {
+        return AnyValue::fromCell_<T>(cell, source.origin);
+    }
+
+    static RenEngineHandle engineOf(AnyValue const & value) {
+        return value.origin;
+    }
+};
+
+} // end namespace internal
+
+} // end namespace ren
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef RENCPP_RING_HPP
+#define RENCPP_RING_HPP
+
+//
+// ring.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+
+
+namespace ren {
+
+
+//
+// BINARY VALUE ENCODING
+//
+
+//
+// The portable way to get a value from one process to another is to FORM or
+// MOLD it on one side and LOAD it on the other.  That works, but the scanner
+// is not fast, and the text is bigger than it needs to be.  So this is a
+// compact binary encoding that the decoder can turn into cells directly:
+//
+//     BLANK!, LOGIC!, INTEGER!, DECIMAL!, CHAR!
+//     STRING!, TAG!, FILE!, URL!, BINARY!
+//     WORD!, SET-WORD!, GET-WORD!, LIT-WORD!, REFINEMENT!, ISSUE!
+//     BLOCK!, GROUP!, PATH!, SET-PATH!, GET-PATH!, LIT-PATH!
+//     OBJECT!
+//
+// Words travel by spelling and arrive unbound (the binding of the sender is
+// meaningless in another process).  Series are encoded from their current
+// index to the tail, the same portion FORM would show.  Numbers are written
+// in the byte order of the machine, since both ends of a shared memory ring
+// are on the same one.  Anything else (FUNCTION!, ERROR!, etc.) is refused
+// with a bad_value_cast from encode(), as are arrays and objects nested more
+// than 256 deep.  The decoder enforces the same limit, so a malformed or
+// hostile record can't run it out of stack.
+//
+
+namespace internal {
+
+class BinaryCodec {
+public:
+    static void encode(
+        AnyValue const & value,
+        std::vector<unsigned char> & out
+    );
+
+    // Returns false if the bytes were malformed (or the runtime failed while
+    // building the cells).  Does not throw.
+    //
+    static bool decode(
+        unsigned char const * data,
+        size_t size,
+        AnyValue & out
+    ) noexcept;
+};
+
+} // end namespace internal
+
+
+
+//
+// SHARED MEMORY RING BUFFER
+//
+
+//
+// A single-producer/single-consumer queue of encoded values, living in a
+// memory mapping that two processes can share.  The producer and consumer
+// each have their own engine; what crosses is only the encoding above.
+//
+// The mapping can be made three ways:
+//
+// * `create(name, bytes)` makes a named POSIX shared memory object, which
+//   another process can `attach(name)` to.  The creator unlinks the name
+//   when it is destroyed.
+//
+// * `anonymous(bytes)` uses a `memfd` where available (and an immediately
+//   unlinked shm object otherwise).  Its `fd()` can be inherited over a
+//   `fork()` or sent over a socket, then opened with `fromFd()`.
+//
+// The capacity is rounded up to a power of two.  Each record is a 32-bit
+// length followed by the encoding, and a record may wrap around the end of
+// the buffer.  The head and tail counters are the only synchronization:
+// the producer publishes `head` with release semantics after writing, and
+// the consumer publishes `tail` after reading.  The batch operations encode
+// or decode several values per publish, which is the point of having them.
+//
+// !!! POSIX only at the moment; the factories throw on Windows.
+//
+
+class SharedRing {
+public:
+    static SharedRing create(std::string const & name, size_t capacity);
+
+    static SharedRing attach(std::string const & name);
+
+    static SharedRing anonymous(size_t capacity);
+
+    static SharedRing fromFd(int fd);
+
+    SharedRing (SharedRing && other) noexcept;
+
+    SharedRing (SharedRing const & other) = delete;
+    SharedRing & operator= (SharedRing const & other) = delete;
+
+    ~SharedRing ();
+
+public:
+    int fd() const { return descriptor; }
+
+    size_t capacity() const;
+
+    bool isEmpty() const;
+
+
+    //
+    // PRODUCER SIDE
+    //
+    // A push which doesn't fit returns false (or, for the batch form, the
+    // number of values from the front of the array that did fit).  Nothing
+    // waits; the client decides whether to spin, sleep, or drop.
+    //
+    // A value whose record could never fit, even in an empty ring, throws
+    // std::length_error (if it's the first one in the batch, otherwise the
+    // values before it are pushed).  A value that refers to itself has no
+    // encoding and throws bad_value_cast.
+    //
+public:
+    bool push(AnyValue const & value);
+
+    size_t push(AnyValue const values[], size_t numValues);
+
+    size_t push(std::vector<AnyValue> const & values) {
+        return push(values.data(), values.size());
+    }
+
+
+    //
+    // CONSUMER SIDE
+    //
+    // Decoded values belong to the engine of the process calling pop().  If
+    // a record fails to decode it is still consumed, and a load_error-style
+    // std::runtime_error is thrown.
+    //
+public:
+    optional<AnyValue> pop();
+
+    size_t pop(std::vector<AnyValue> & out, size_t maxValues);
+
+
+private:
+    struct Header;
+
+    SharedRing (int descriptor, bool owner, std::string const & name);
+
+    void map(bool initialize, size_t capacity);
+
+    void writeBytes(uint64_t position, void const * data, size_t size);
+
+    void readBytes(uint64_t position, void * data, size_t size) const;
+
+    int descriptor;
+    bool owner;
+    std::string name;
+
+    Header * header;
+    unsigned char * ring;
+    size_t mappedSize;
+
+    std::vector<unsigned char> scratch; // reused between calls
+};
+
+} // end namespace ren
+
+#endif
@@ -19,7 +19,10 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <exception>
 #include <initializer_list>
+#include <string>
+#include <vector>
 
 #include "common.hpp"
 #include "value.hpp"
@@ -29,6 +32,46 @@
 namespace ren {
 
 
+//
+// RESULTS OF BATCH EVALUATION
+//
+
+//
+// Each snippet given to Runtime::evaluateBatch() gets one of these, so that
+// a failure in one snippet doesn't lose the results of the others.  get()
+// gives the value, or rethrows the load_error, evaluation_error, or
+// evaluation_throw that a plain evaluation of the snippet would have thrown.
+//
+
+class BatchResult {
+private:
+    optional<AnyValue> result;
+    std::exception_ptr failure;
+
+public:
+    BatchResult (optional<AnyValue> const & result) :
+        result (result)
+    {
+    }
+
+    BatchResult (std::exception_ptr failure) :
+        failure (failure)
+    {
+    }
+
+    bool succeeded() const { return !failure; }
+
+    std::exception_ptr exception() const { return failure; }
+
+    optional<AnyValue> const & get() const {
+        if (failure)
+            std::rethrow_exception(failure);
+        return result;
+    }
+};
+
+
+
 //
 // BASE RUNTIME CLASS
 //
@@ -84,6 +127,39 @@ public:
         );
     }
 
+    //
+    // Evaluates many independent snippets of source, e.g. the rules of a
+    // rule engine.  All of them are scanned and then bound into the context
+    // together (so new words are resolved against lib once), and they are
+    // evaluated in order under a single trap.  Errors in one snippet are
+    // recorded in its result and the batch carries on; only a halt aborts
+    // the whole batch, by throwing evaluation_halt.
+    //
+    // Each snippet is bound into the same context, so variables set by one
+    // are seen by the snippets after it.
+    //
+protected:
+    static std::vector<BatchResult> evaluateBatch(
+        std::vector<std::string> const & sources,
+        AnyContext const * contextPtr,
+        Engine * engine
+    );
+
+public:
+    static std::vector<BatchResult> evaluateBatch(
+        std::vector<std::string> const & sources,
+        Engine * engine = nullptr
+    ) {
+        return evaluateBatch(sources, nullptr, engine);
+    }
+
+    static std::vector<BatchResult> evaluateBatch(
+        std::vector<std::string> const & sources,
+        AnyContext const & context
+    ) {
+        return evaluateBatch(sources, &context, nullptr);
+    }
+
     // Has ambiguity error from trying to turn the nullptr into a Loadable;
     // investigate what it is about the static method that has this problem
 
@@ -73,22 +73,33 @@ protected:
     // The series thus functions as the state, but is a separate type that
     // has to be wrapped up.
 public:
+    //
+    // The iterator is the series' cell (borrowed, so the series must outlive
+    // it) and an index.  It compares by index, so stepping through doesn't
+    // copy or compare any cells.
+    //
     class iterator {
         friend class AnySeries;
-        internal::AnySeries_ state;
-        iterator (internal::AnySeries_ const & state) :
-            state (state)
+
+        REBVAL const * series;
+        size_t index;
+        RenEngineHandle origin;
+
+        iterator (REBVAL const * series, size_t index, RenEngineHandle origin) :
+            series (series),
+            index (index),
+            origin (origin)
         {
         }
 
     public:
         iterator & operator++() {
-            ++state;
+            ++index;
             return *this;
         }
 
         iterator & operator--() {
-            --state;
+            --index;
             return *this;
         }
 
@@ -105,23 +116,17 @@ public:
         }
 
         bool operator==(iterator const & other) const
-            { return state.isSameAs(other.state); }
+            { return index == other.index; }
         bool operator!=(iterator const & other) const
-            { return !state.isSameAs(other.state); }
+            { return index != other.index; }
 
-        AnyValue operator * () const { return *state; }
-        AnyValue operator-> () const { return state.operator->(); }
+        AnyValue operator * () const;
+        AnyValue operator-> () const { return *(*this); }
     };
 
-    iterator begin() const {
-        return iterator (*this);
-    }
+    iterator begin() const;
 
-    iterator end() const {
-        auto temp = *this;
-        temp.tail(); // see remarks on tail modifying vs. returning a value
-        return iterator (temp);
-    }
+    iterator end() const;
 
     size_t length() const;
 
@@ -137,6 +142,31 @@ public:
     // Note: Rebol/Red use 1-based indexing with a "zero-hole" by default
 
     AnyValue operator[](AnyValue const & index) const;
+
+    // An integer in range picks the element directly, without evaluating
+    // PICK.  (Others, like 0 or past the tail, go through PICK for its
+    // answer.)
+    //
+    AnyValue operator[](int index) const;
+
+
+    //
+    // The members that modify a series call the same routines as APPEND,
+    // INSERT, REMOVE and friends, without scanning, binding or evaluating.
+    // Offsets are 0-based from the series' position (as with its iterators),
+    // and throw std::out_of_range if they're past the tail.  Modifying a
+    // protected series throws std::runtime_error.
+    //
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void remove(size_t offset, size_t count = 1); // stops at the tail
+
+    void clear(); // from the position to the tail, as CLEAR does
+
+    // Makes room for `count` more elements, so appending them doesn't have
+    // to reallocate
+    //
+    void reserve(size_t count);
 };
 
 } // end namespace ren
@@ -0,0 +1,257 @@
+#ifndef RENCPP_SNAPSHOT_HPP
+#define RENCPP_SNAPSHOT_HPP
+
+//
+// snapshot.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "value.hpp"
+
+
+namespace ren {
+
+
+//
+// IMMUTABLE SNAPSHOTS OF DATA
+//
+
+//
+// Reading a Block or Object means going through the interpreter, which can
+// only serve one thread at a time (see %executor.hpp).  For data that is
+// built once and then consulted by many threads--configuration, lookup
+// tables--that serializes all the readers for no good reason.
+//
+// A Snapshot is a copy of a value's structure exported into plain C++
+// memory.  All of its nodes sit in one contiguous vector, with children of
+// an array or object adjacent, and all text (strings and word spellings) in
+// a single buffer of UTF-8.  Once made it never changes, so any number of
+// threads may read it at once without locks or the engine.  Copying a
+// Snapshot just shares the same storage.
+//
+//     Snapshot config {static_cast<Block>(*runtime("load %config.reb"))};
+//
+//     // ...then on any thread...
+//     Snapshot::View server = config.root()["server"];
+//     int64_t port = server["port"].asInteger();
+//     for (Snapshot::View host : server["hosts"])
+//         connect(host.str());
+//
+// Keyed lookup works on objects (by field name) and on blocks written in
+// the `key: value` style (the value after a SET-WORD!).  Keys are compared
+// case-insensitively for ASCII, as Rebol compares words.  Lookups are a
+// binary search over a sorted index made when the snapshot is taken.
+//
+// Values of types without a C++ representation here (DATE!, TUPLE!, ...)
+// are kept as Kind::Other with their MOLD as text.  FUNCTION!s and cyclic
+// structures can't be snapshotted, and throw from the constructor.
+//
+
+class Snapshot {
+public:
+    enum class Kind : unsigned char {
+        Blank,
+        Logic,
+        Integer,
+        Decimal,
+        Char,
+
+        String, // also TAG!, FILE!, URL!, etc.
+        Binary,
+
+        Word,
+        SetWord,
+        GetWord,
+        LitWord,
+        Refinement,
+        Issue,
+
+        Block,
+        Group,
+        Path, // also SET-PATH!, GET-PATH!, LIT-PATH!
+
+        Object,
+
+        Other
+    };
+
+private:
+    struct Node;
+    struct KeyEntry;
+    struct Data;
+    struct Builder;
+
+    std::shared_ptr<Data const> data;
+
+public:
+    class View;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = View;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = View;
+
+    private:
+        friend class View;
+        Data const * data;
+        uint32_t index;
+
+        const_iterator (Data const * data, uint32_t index) :
+            data (data), index (index) {}
+
+    public:
+        View operator*() const { return View {data, index}; }
+        View operator[](difference_type n) const { return *(*this + n); }
+
+        const_iterator & operator++() { ++index; return *this; }
+        const_iterator operator++(int) { auto t = *this; ++index; return t; }
+        const_iterator & operator--() { --index; return *this; }
+        const_iterator operator--(int) { auto t = *this; --index; return t; }
+
+        const_iterator & operator+=(difference_type n) {
+            index = static_cast<uint32_t>(
+                static_cast<difference_type>(index) + n
+            );
+            return *this;
+        }
+        const_iterator & operator-=(difference_type n) { return *this += -n; }
+
+        const_iterator operator+(difference_type n) const {
+            auto t = *this; return t += n;
+        }
+        const_iterator operator-(difference_type n) const {
+            auto t = *this; return t -= n;
+        }
+        difference_type operator-(const_iterator const & other) const {
+            return static_cast<difference_type>(index)
+                - static_cast<difference_type>(other.index);
+        }
+
+        bool operator==(const_iterator const & other) const {
+            return index == other.index;
+        }
+        bool operator!=(const_iterator const & other) const {
+            return index != other.index;
+        }
+        bool operator<(const_iterator const & other) const {
+            return index < other.index;
+        }
+        bool operator>(const_iterator const & other) const {
+            return index > other.index;
+        }
+        bool operator<=(const_iterator const & other) const {
+            return index <= other.index;
+        }
+        bool operator>=(const_iterator const & other) const {
+            return index >= other.index;
+        }
+    };
+
+
+    //
+    // A View is a pointer into a snapshot, and is cheap to copy.  It does
+    // not keep the snapshot alive; the Snapshot must outlive its views.
+    //
+    class View {
+    private:
+        friend class Snapshot;
+        friend class const_iterator;
+
+        Data const * data;
+        uint32_t index;
+
+        View (Data const * data, uint32_t index) :
+            data (data), index (index) {}
+
+        Node const & node() const;
+
+    public:
+        Kind kind() const;
+
+        bool isArray() const; // BLOCK!, GROUP!, or PATH!
+        bool isObject() const { return kind() == Kind::Object; }
+        bool isWord() const; // any word type
+        bool hasText() const; // strings, binaries, words, and Other
+
+        // These throw bad_value_cast if the kind doesn't match.  (asDecimal()
+        // will also accept an INTEGER!, and the text accessors any kind for
+        // which hasText() is true.)
+        //
+        bool asLogic() const;
+        int64_t asInteger() const;
+        double asDecimal() const;
+        uint32_t asChar() const;
+
+        // For strings this is the text, for words the spelling, for a BINARY!
+        // the bytes, and for Kind::Other the molded form.
+        //
+        char const * textData() const; // not NUL-terminated
+        size_t textSize() const;
+        std::string str() const;
+
+        // For arrays and objects, the number of elements or fields
+        //
+        size_t size() const;
+        bool empty() const { return size() == 0; }
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        View operator[](size_t index) const; // throws std::out_of_range
+        View operator[](int index) const { // else [0] is ambiguous
+            return (*this)[static_cast<size_t>(index)];
+        }
+
+        // For objects, the name of field `index`
+        //
+        std::string keyAt(size_t index) const;
+
+        // Keyed lookup in an object or `key: value` block.  find() gives
+        // nullopt if there's no such key, operator[] throws out_of_range.
+        //
+        optional<View> find(std::string const & key) const;
+
+        View operator[](std::string const & key) const;
+        View operator[](char const * key) const {
+            return (*this)[std::string {key}];
+        }
+    };
+
+public:
+    // Takes a deep snapshot of the value, which is usually a block or an
+    // object.  Must be called by a thread that may use the engine.
+    //
+    explicit Snapshot (AnyValue const & value);
+
+    View root() const { return View {data.get(), 0}; }
+
+    // Total number of nodes and bytes of text, for sizing diagnostics
+    //
+    size_t nodeCount() const;
+    size_t textBytes() const;
+};
+
+} // end namespace ren
+
+#endif
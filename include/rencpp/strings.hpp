@@ -19,6 +19,12 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
 #include "value.hpp"
 #include "atoms.hpp"
 #include "series.hpp"
@@ -47,7 +53,17 @@ public:
     static void initFilename(REBVAL *cell);
 
 protected:
-    AnyString(
+    // Text is UTF-8, and is copied once, directly into the new series (it
+    // isn't LOADed, so it needn't be escaped).  Invalid UTF-8 throws.
+    //
+    AnyString (
+        char const * data,
+        size_t size,
+        internal::CellFunction cellfun,
+        Engine * engine = nullptr
+    );
+
+    AnyString (
         char const * cstr,
         internal::CellFunction cellfun,
         Engine * engine = nullptr
@@ -73,7 +89,11 @@ public:
     //
     //     https://github.com/hostilefork/rencpp/issues/6
 
-    operator std::string () const { return to_string(*this); }
+    //
+    // It gives the same text as FORM (so a TAG! keeps its angle brackets),
+    // but copies it out of the series instead of molding it.
+
+    operator std::string () const;
 
 #if REN_CLASSLIB_QT == 1
     operator QString () const { return to_QString(*this); }
@@ -83,8 +103,8 @@ public:
 public:
     class iterator {
         friend class AnyString;
-        AnySeries state;
-        iterator (AnySeries const & state) :
+        AnySeries::iterator state;
+        iterator (AnySeries::iterator const & state) :
             state (state)
         {
         }
@@ -113,25 +133,24 @@ public:
         }
 
         bool operator==(iterator const & other) const
-            { return state.isSameAs(other.state); }
+            { return state == other.state; }
         bool operator!=(iterator const & other) const
-            { return !state.isSameAs(other.state); }
+            { return state != other.state; }
 
         Character operator * () const {
             return static_cast<Character>(*state);
         }
         Character operator-> () const {
-            return static_cast<Character>(state.operator->()); }
+            return static_cast<Character>(*state);
+        }
     };
 
     iterator begin() const {
-        return iterator (*this);
+        return iterator (AnySeries::begin());
     }
 
     iterator end() const {
-        auto temp = *this;
-        temp.tail();
-        return iterator (temp);
+        return iterator (AnySeries::end());
     }
 
 public:
@@ -147,12 +166,195 @@ public:
 #endif
 
     bool hasSpelling(char const * spelling) const {
-        return spellingOf_STD() == spelling;
+        return hasSpelling_(spelling);
     }
 
     bool isEqualTo(char const * cstr) const {
-        return static_cast<std::string>(*this) == cstr;
+        return hasSpelling_(cstr);
     }
+
+
+public:
+    //
+    // The interpreter doesn't store strings as UTF-8: a series holds one
+    // byte per character if they all fit in Latin-1, else a wide character
+    // each.  utf8View() gives the text from the string's position to its
+    // tail as UTF-8 without FORMing it.  If that text is all ASCII, the view
+    // points straight at the series data; otherwise it's encoded once, into
+    // a buffer the view owns.
+    //
+    // codepoints() iterates the characters as char32_t, read directly out of
+    // the series memory, where iterating the string itself makes a Character
+    // value for each one.
+    //
+    // Both hold a reference to the string, so the series won't be GC'd out
+    // from under them.  !!! As with iterators into a std::string, modifying
+    // the string while a view or range is alive may invalidate it.
+    //
+    class Utf8View;
+    class Codepoints;
+
+    Utf8View utf8View() const;
+    Codepoints codepoints() const;
+
+
+public:
+    //
+    // Searches that scan the series memory directly, sixteen bytes at a
+    // time with SSE2 where it's available (see %search.cpp).  Text to look
+    // for is UTF-8, and positions are in characters from the string's index,
+    // or npos.  Characters are matched exactly, so case matters (as with
+    // FIND/CASE).  The same searches are natives for Ren code: FIND-TEXT,
+    // FIND-ANY-CHAR, COUNT-CHAR, COUNT-LINES, and SPLIT-TEXT.
+    //
+    size_t find(char const * needle) const;
+    size_t find(std::string const & needle) const;
+    size_t find(char32_t c) const;
+
+    size_t findAnyOf(char const * chars) const;
+
+    size_t count(char32_t c) const;
+
+    // A last line with no newline at its end is counted
+    //
+    size_t countLines() const;
+
+    std::vector<std::string> split(char32_t delimiter) const;
+
+
+public:
+    //
+    // Modifying in place (see the notes in AnySeries).  Text is UTF-8, and
+    // the string is widened if what's added isn't Latin-1.
+    //
+    void insert(size_t offset, char const * utf8, size_t size);
+
+    void insert(size_t offset, std::string const & utf8) {
+        insert(offset, utf8.data(), utf8.size());
+    }
+
+    void insert(size_t offset, char32_t c);
+
+    void append(char const * utf8, size_t size) {
+        insert(length(), utf8, size);
+    }
+
+    void append(char const * utf8);
+
+    void append(std::string const & utf8) {
+        insert(length(), utf8.data(), utf8.size());
+    }
+
+    void append(char32_t c) { insert(length(), c); }
+
+    void poke(size_t offset, char32_t c);
+};
+
+
+
+//
+// UTF-8 VIEWS AND CODEPOINT RANGES
+//
+
+class AnyString::Utf8View {
+private:
+    friend class AnyString;
+
+    AnyString string; // keeps the series alive
+    char const * direct; // into the series, or nullptr if encoded
+    size_t length;
+    std::string encoded;
+
+    explicit Utf8View (AnyString const & string) :
+        string (string), direct (nullptr), length (0) {}
+
+public:
+    char const * data() const { return direct ? direct : encoded.data(); }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    char const * begin() const { return data(); }
+    char const * end() const { return data() + length; }
+
+    // True if no copy was made
+    //
+    bool isDirect() const { return direct != nullptr; }
+
+    std::string str() const { return std::string {data(), length}; }
+
+#if REN_STRING_VIEW == 1
+    std::string_view view() const { return std::string_view {data(), length}; }
+    operator std::string_view () const { return view(); }
+#endif
+};
+
+
+class AnyString::Codepoints {
+private:
+    friend class AnyString;
+
+    AnyString string; // keeps the series alive
+    unsigned char const * head;
+    size_t wide; // bytes per character in the series (1, 2, or 4)
+    size_t count;
+
+    Codepoints (
+        AnyString const & string,
+        unsigned char const * head,
+        size_t wide,
+        size_t count
+    ) :
+        string (string), head (head), wide (wide), count (count) {}
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = char32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = char32_t;
+
+    private:
+        friend class Codepoints;
+        unsigned char const * at;
+        size_t wide;
+
+        const_iterator (unsigned char const * at, size_t wide) :
+            at (at), wide (wide) {}
+
+    public:
+        char32_t operator*() const {
+            if (wide == 1)
+                return *at;
+            if (wide == 2) {
+                uint16_t c;
+                memcpy(&c, at, sizeof(c));
+                return c;
+            }
+            uint32_t c;
+            memcpy(&c, at, sizeof(c));
+            return c;
+        }
+
+        const_iterator & operator++() { at += wide; return *this; }
+        const_iterator operator++(int) { auto t = *this; at += wide; return t; }
+
+        bool operator==(const_iterator const & other) const {
+            return at == other.at;
+        }
+        bool operator!=(const_iterator const & other) const {
+            return at != other.at;
+        }
+    };
+
+    const_iterator begin() const { return const_iterator {head, wide}; }
+    const_iterator end() const {
+        return const_iterator {head + count * wide, wide};
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
 };
 
 
@@ -195,11 +397,27 @@ public:
     {
     }
 
+    AnyString_ (
+        char const * data,
+        size_t size,
+        Engine * engine = nullptr
+    ) :
+        AnyString (data, size, F, engine)
+    {
+    }
+
     explicit AnyString_ (std::string const & str, Engine * engine = nullptr) :
-        AnyString (str.c_str(), F, engine)
+        AnyString (str, F, engine)
     {
     }
 
+#if REN_STRING_VIEW == 1
+    explicit AnyString_ (std::string_view str, Engine * engine = nullptr) :
+        AnyString (str.data(), str.size(), F, engine)
+    {
+    }
+#endif
+
 #if REN_CLASSLIB_QT == 1
     explicit AnyString_ (QString const & str, Engine * engine = nullptr) :
         AnyString (str, F, engine)
@@ -255,9 +473,21 @@ public:
     }
 
     String (std::string const & str, Engine * engine = nullptr) :
-        AnyString_ (str.c_str(), engine)
+        AnyString_ (str, engine)
+    {
+    }
+
+    String (char const * data, size_t size, Engine * engine = nullptr) :
+        AnyString_ (data, size, engine)
+    {
+    }
+
+#if REN_STRING_VIEW == 1
+    String (std::string_view str, Engine * engine = nullptr) :
+        AnyString_ (str, engine)
     {
     }
+#endif
 
 #if REN_CLASSLIB_QT == 1
     String (QString const & str, Engine * engine = nullptr) :
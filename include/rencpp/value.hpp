@@ -24,7 +24,9 @@
 #include <initializer_list>
 #include <iosfwd>
 #include <stdexcept>
+#include <string>
 #include <utility> // std::forward
+#include <vector>
 
 #include <atomic>
 #include <type_traits>
@@ -70,6 +72,18 @@ class AnyContext;
 
 class Engine;
 
+class EnginePool;
+
+class Snapshot;
+
+class ContextPool;
+
+class Symbol;
+class StringBuilder;
+
+class AnyWord;
+class AnyString;
+
 
 namespace internal {
     //
@@ -83,9 +97,27 @@ namespace internal {
 
     class RebolHooks;
 
+    class BinaryCodec;
+
+    class ParallelMapper;
+    class ArrayBuilder;
+    class Reduction;
+
+    template <class T>
+    struct BlockOfElement;
+
     template <class R, class... Ts>
     class FunctionGenerator;
 
+    // The type a function shim makes from an argument's cell (see
+    // %function.hpp).  It's the parameter's own type, unless the parameter
+    // type is made from a value, as BlockOf<T> is made from a Block.
+
+    template <class T>
+    struct ArgumentCell {
+        using type = T;
+    };
+
     // We want to be able to pass a Context to the constructors.  However, the
     // Context itself is a legal Ren type!  This "ContextWrapper" is used to
     // carry a context without itself being a candidate to be a Loadable.
@@ -143,6 +175,14 @@ std::string to_string (AnyValue const & value);
 QString to_QString(AnyValue const & value);
 #endif
 
+// Each to_string() call sets up a trap of its own (a setjmp and a save of
+// the interpreter state) for the FORM.  form() does a whole batch of values
+// under one trap, and mold() MOLDs them.  FORM and MOLD don't evaluate, so
+// nothing in the batch can call back into C++ code.
+
+std::vector<std::string> form(std::vector<AnyValue> const & values);
+std::vector<std::string> mold(std::vector<AnyValue> const & values);
+
 
 
 //
@@ -223,8 +263,21 @@ public:
 protected:
     friend class ren::internal::Loadable; // for string class constructors
     friend class AnySeries; // !!! needs to write path cell in operator[] ?
+    friend class AnyArray; // elements compare and assign cells directly
     friend class Function; // needs to extract series from spec block
     friend class ren::internal::AnySeries_; // iterator state
+    friend class EnginePool; // molds results in worker processes
+    friend class internal::BinaryCodec; // encodes/decodes cells directly
+    friend class internal::ParallelMapper; // extracts elements in one pass
+    friend class internal::ArrayBuilder; // writes cells straight into arrays
+    friend class internal::Reduction; // reads numbers straight from cells
+    template <class T> // reads BlockOf elements straight from cells
+    friend struct internal::BlockOfElement;
+    friend class Snapshot; // copies whole trees out of the cells
+    friend class ContextPool; // resets pooled contexts' variables
+    friend class Symbol; // roots the spellings it interns
+    friend class AnyWord; // binds words made from a Symbol
+    friend class StringBuilder; // appends into the series it hands over
 
     REBVAL *cell;
 
@@ -346,6 +399,29 @@ protected:
         return result;
     }
 
+    // An element in an array may be relative to the array's specifier (if
+    // it's in the body of a function), so AnyArray::Element copies cells out
+    // with this instead of fromCell_.  The type has already been checked.
+    //
+    template <class T>
+    static T fromElement_(
+        REBVAL const * element, REBVAL const * array, RenEngineHandle engine
+    ) {
+        T result (Dont::Initialize);
+        copyElement_(result.cell, element, array);
+        result.finishInit(engine);
+        return result;
+    }
+
+    static void copyElement_(
+        REBVAL * out, REBVAL const * element, REBVAL const * array
+    ); // see %arrays.cpp
+
+    template <class T>
+    static bool isValidCell_(REBVAL const * cell) {
+        return T::isValid(cell);
+    }
+
 
 public:
     static void toCell_(
@@ -499,6 +575,13 @@ public:
 public:
     friend std::string to_string (AnyValue const & value);
 
+    friend std::vector<std::string> form(
+        std::vector<AnyValue> const & values
+    );
+    friend std::vector<std::string> mold(
+        std::vector<AnyValue> const & values
+    );
+
 #if REN_CLASSLIB_QT == 1
     friend QString to_QString(AnyValue const & value);
 #endif
@@ -646,23 +729,37 @@ public:
 
 
 public:
-    // This can probably be done more efficiently, but the idea of wanting
-    // to specify a type and a spelling in a single check without having
-    // to go through a cast is a nice convenient.  Only works for types
-    // that have a "hasSpelling" method (strings, words)
+    // The idea of wanting to specify a type and a spelling in a single check
+    // without having to go through a cast is a nice convenient.  Only works
+    // for types that have a "hasSpelling" method (strings, words), and is
+    // exact (case matters).  The text is compared straight from the cell,
+    // without making a value of the type.
 
     template <class T>
     bool isEqualTo(char const * spelling) const {
-        if (!T::isValid(cell))
-            return false;
-
-        T result (Dont::Initialize);
-        RL_Move(result.cell, cell);
-        result.finishInit(origin);
+        static_assert(
+            std::is_base_of<AnyWord, T>::value
+            || std::is_base_of<AnyString, T>::value,
+            "isEqualTo<T>(spelling) is only for word and string types"
+        );
+        return T::isValid(cell) && hasSpelling_(spelling);
+    }
 
-        return result.hasSpelling(spelling);
+    // Any word type with the given spelling (ignoring case, as Rebol does
+    // when comparing words).  This is a pointer comparison.
+    //
+    template <class T>
+    bool isEqualTo(Symbol const & symbol) const {
+        return T::isValid(cell) && hasWordSymbol(symbol);
     }
 
+protected:
+    bool hasWordSymbol(Symbol const & symbol) const; // see %words.cpp
+
+    // The cell must be a word or string
+    //
+    bool hasSpelling_(char const * utf8) const; // see %value.cpp
+
 
 protected:
     //
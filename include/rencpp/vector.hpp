@@ -0,0 +1,147 @@
+#ifndef RENCPP_VECTOR_HPP
+#define RENCPP_VECTOR_HPP
+
+//
+// vector.hpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "value.hpp"
+#include "series.hpp"
+
+
+namespace ren {
+
+
+//
+// VECTOR
+//
+
+//
+// A VECTOR! holds its elements as plain numbers of one type, packed one after
+// another like a C array.  So unlike a Block of numbers, its data can be
+// handed to C++ code as a pointer (or std::span, in C++20) with no copying
+// or checking of each element:
+//
+//     std::vector<float> samples = readSamples();
+//     Vector<float> wave {samples}; // one copy, in one memcpy
+//     runtime("process-wave", wave);
+//
+//     Vector<float> result = static_cast<Vector<float>>(
+//         *runtime("process-wave", wave)
+//     );
+//     float const * out = result.data(); // no copy
+//
+// The element type is checked once, when a value is cast to a Vector<T>; a
+// VECTOR! of some other type throws bad_value_cast.  The types are the ones
+// the interpreter has: 8, 16, 32 and 64 bit integers (signed and unsigned),
+// float, and double.
+//
+// data() points at the element at the vector's position.  Like a pointer into
+// a std::vector, it's good until the vector is modified in a way that could
+// reallocate it (appending, inserting, reserve()).
+//
+
+namespace internal {
+
+// The interpreter's code for each element type, as kept in the series (see
+// %t-vector.c): the low two bits are the size (8, 16, 32 or 64 bits), then
+// a bit for unsigned, and one for floating point.
+
+template <class T>
+struct VectorElement {
+    static_assert(
+        std::is_arithmetic<T>::value && !std::is_same<T, bool>::value
+        && (std::is_integral<T>::value || sizeof(T) >= 4)
+        && sizeof(T) <= 8,
+        "VECTOR! elements are 8 to 64 bit integers, float, or double"
+    );
+
+    static constexpr int encoding =
+        (std::is_floating_point<T>::value ? 8 : 0)
+        + (std::is_unsigned<T>::value ? 4 : 0)
+        + (sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3);
+};
+
+} // end namespace internal
+
+
+class AnyVector : public AnySeries {
+protected:
+    friend class AnyValue;
+    AnyVector (Dont) noexcept : AnySeries (Dont::Initialize) {}
+    static bool isValid(REBVAL const * cell);
+
+    static int encodingOf(REBVAL const * cell);
+
+    void initVector(
+        int encoding,
+        void const * data,
+        size_t count,
+        Engine * engine
+    );
+
+    void * dataAt() const;
+};
+
+
+template <class T>
+class Vector : public AnyVector {
+protected:
+    friend class AnyValue;
+    Vector (Dont) noexcept : AnyVector (Dont::Initialize) {}
+
+    static bool isValid(REBVAL const * cell) {
+        return AnyVector::isValid(cell)
+            && encodingOf(cell) == internal::VectorElement<T>::encoding;
+    }
+
+public:
+    Vector (T const * data, size_t count, Engine * engine = nullptr) :
+        AnyVector (Dont::Initialize)
+    {
+        initVector(internal::VectorElement<T>::encoding, data, count, engine);
+    }
+
+    explicit Vector (
+        std::vector<T> const & values,
+        Engine * engine = nullptr
+    ) :
+        Vector (values.data(), values.size(), engine)
+    {
+    }
+
+#if REN_SPAN == 1
+    explicit Vector (std::span<T const> values, Engine * engine = nullptr) :
+        Vector (values.data(), values.size(), engine)
+    {
+    }
+#endif
+
+    T * data() const { return static_cast<T *>(dataAt()); }
+
+#if REN_SPAN == 1
+    std::span<T> span() const { return std::span<T> {data(), length()}; }
+#endif
+};
+
+} // end namespace ren
+
+#endif
@@ -19,10 +19,107 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <string>
+
 #include "value.hpp"
 
 namespace ren {
 
+//
+// SYMBOLS
+//
+
+//
+// Every word refers to an interned spelling in the engine, and all words
+// with the same spelling share it.  A Symbol is a handle to one of these.
+// It's the size of a few pointers, so it's cheap to copy, and two Symbols
+// are equal when their spellings are (ignoring case for ASCII, as Rebol
+// does when comparing words)--a pointer comparison:
+//
+//     Symbol print {"print"};
+//     if (word.symbol() == print) ...
+//
+// The `_sym` literal interns a spelling the first time a given literal is
+// used, and after that returns the same Symbol without going to the engine:
+//
+//     if (value.isEqualTo<Word>("else"_sym)) ...
+//
+// Literals are looked up by address, and the text is compared with the
+// Symbol found there before it's used, so a literal that was unloaded (with
+// its module) and whose address was reused for other text isn't mistaken
+// for the old one.
+//
+// Words made from a Symbol are created directly, without the scanner.  So
+// no check is made that the spelling is a valid word (`Word {Symbol {"a b"}}`
+// is a word that would MOLD as "a b").
+//
+// Spellings are kept alive for the life of the engine once a Symbol has
+// been made for them from text or a `_sym` literal, so those never dangle
+// while it runs.  When the runtime shuts down they're all let go, and any
+// Symbol still held is invalid.
+// (They're the vocabulary of a program, and are usually few.)  The Symbol
+// from AnyWord::symbol() isn't kept, so it's free to get for each word of
+// loaded data; it's good as long as the word (or anything else using that
+// spelling) is.
+//
+
+class Symbol {
+private:
+    friend class AnyWord;
+    friend class AnyValue;
+
+    void const * spelling; // REBSTR *
+    void const * canon; // REBSTR * shared by spellings differing in case
+    char const * head;
+    size_t length;
+
+    explicit Symbol (void const * spelling); // not kept alive
+
+public:
+    explicit Symbol (char const * utf8, Engine * engine = nullptr);
+
+    Symbol (char const * utf8, size_t size, Engine * engine = nullptr);
+
+    explicit Symbol (std::string const & str, Engine * engine = nullptr) :
+        Symbol (str.data(), str.size(), engine)
+    {
+    }
+
+    // The spelling as written when first interned, in UTF-8.  It is NOT
+    // terminated, so always use size() with data().
+    //
+    char const * data() const { return head; }
+    size_t size() const { return length; }
+
+    std::string str() const { return std::string {head, length}; }
+
+#if REN_STRING_VIEW == 1
+    std::string_view view() const { return std::string_view {head, length}; }
+#endif
+
+    bool operator==(Symbol const & other) const {
+        return canon == other.canon;
+    }
+    bool operator!=(Symbol const & other) const {
+        return canon != other.canon;
+    }
+
+    // Unlike ==, distinguishes `foo` from `FOO`
+    //
+    bool isSameSpellingAs(Symbol const & other) const {
+        return spelling == other.spelling;
+    }
+};
+
+
+inline namespace literals {
+
+Symbol operator"" _sym(char const * utf8, size_t size);
+
+} // end namespace literals
+
+
+
 //
 // ANYWORD
 //
@@ -64,6 +161,16 @@ protected:
     );
 #endif
 
+    // Made directly from the interned spelling, and bound to the context
+    // (as if the word had been LOADed there)
+    //
+    explicit AnyWord (
+        Symbol const & symbol,
+        internal::CellFunction cellfun,
+        AnyContext const * context = nullptr,
+        Engine * engine = nullptr
+    );
+
     // Copy from any other AnyWord, preserve binding but change type
     explicit AnyWord (AnyWord const & other, internal::CellFunction cellfun);
 
@@ -108,9 +215,15 @@ public:
     QString spellingOf_QT() const;
 #endif
 
-    bool hasSpelling(char const * spelling) const {
-        return spellingOf_STD() == spelling;
+    bool hasSpelling(char const * spelling) const; // exact, case matters
+
+    // Compares as words do, ignoring case (see Symbol's operator==)
+    //
+    bool isSameWordAs(Symbol const & symbol) const {
+        return hasWordSymbol(symbol);
     }
+
+    Symbol symbol() const;
 };
 
 // http://stackoverflow.com/a/3052604/211160
@@ -163,6 +276,16 @@ public:
     {
     }
 
+    explicit AnyWord_ (Symbol const & symbol, Engine * engine = nullptr) :
+        AnyWord (symbol, F, nullptr, engine)
+    {
+    }
+
+    explicit AnyWord_ (Symbol const & symbol, AnyContext & context) :
+        AnyWord (symbol, F, &context, nullptr)
+    {
+    }
+
 #if REN_CLASSLIB_QT == 1
     explicit AnyWord_ (QString const & str, Engine * engine = nullptr) :
         AnyWord (str, F, nullptr, engine)
@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <numeric>
 #include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "rencpp/value.hpp"
 #include "rencpp/arrays.hpp"
 #include "rencpp/context.hpp"
+#include "rencpp/engine.hpp"
 
 #include "rencpp/rebol.hpp"
 
@@ -78,6 +87,451 @@ void AnyArray::initLitPath(REBVAL *cell) {
 }
 
 
+//
+// ELEMENT ACCESS
+//
+
+void AnyValue::copyElement_(
+    REBVAL * out, REBVAL const * element, REBVAL const * array
+) {
+    Derelativize(out, element, VAL_SPECIFIER(array));
+}
+
+
+AnyArray::iterator AnyArray::begin() const {
+    return iterator {cell, VAL_INDEX(cell), origin};
+}
+
+
+AnyArray::iterator AnyArray::end() const {
+    return iterator {cell, VAL_LEN_HEAD(cell), origin};
+}
+
+
+AnyArray::Element AnyArray::iterator::operator*() const {
+    // The REBVAL * is really a RELVAL *, which Element only hands to
+    // Derelativize() and type tests
+    //
+    return Element {
+        array,
+        reinterpret_cast<REBVAL *>(
+            ARR_AT(VAL_ARRAY(array), static_cast<REBCNT>(index))
+        ),
+        origin
+    };
+}
+
+
+AnyArray::Element const & AnyArray::Element::operator=(
+    AnyValue const & value
+) const {
+    internal::checkWritable(array);
+    Move_Value(cell, value.cell);
+    return *this;
+}
+
+
+AnyArray::Element const & AnyArray::Element::operator=(
+    Element const & other
+) const {
+    if (cell != other.cell) {
+        internal::checkWritable(array);
+        Derelativize(cell, other.cell, VAL_SPECIFIER(other.array));
+    }
+    return *this;
+}
+
+
+// The cells are exchanged bit for bit.  That's fine within an array, but
+// would be wrong for a relative value swapped into another array, so
+// elements of arrays in function bodies shouldn't be swapped between them.
+//
+void swap(AnyArray::Element a, AnyArray::Element b) {
+    if (a.cell == b.cell)
+        return;
+
+    internal::checkWritable(a.array);
+    if (b.array != a.array)
+        internal::checkWritable(b.array);
+
+    DECLARE_LOCAL (temp);
+    Blit_Cell(temp, a.cell);
+    Blit_Cell(a.cell, b.cell);
+    Blit_Cell(b.cell, temp);
+}
+
+
+bool AnyArray::Element::isEqualTo(AnyValue const & other) const {
+    DECLARE_LOCAL (cell_copy);
+    copyElement_(cell_copy, cell, array);
+    DECLARE_LOCAL (other_copy);
+    toCell_(other_copy, other);
+
+    // !!! Modifies arguments to coerce them for testing!
+    return Compare_Modify_Values(cell_copy, other_copy, 0);
+}
+
+
+bool AnyArray::Element::isSameAs(AnyValue const & other) const {
+    DECLARE_LOCAL (cell_copy);
+    copyElement_(cell_copy, cell, array);
+    DECLARE_LOCAL (other_copy);
+    toCell_(other_copy, other);
+
+    // !!! Modifies arguments to coerce them for testing
+    return Compare_Modify_Values(cell_copy, other_copy, 3);
+}
+
+
+
+//
+// ORDERING
+//
+
+bool AnyArray::Less::lessCells(REBVAL const * a, REBVAL const * b) {
+    if (IS_INTEGER(a) && IS_INTEGER(b))
+        return VAL_INT64(a) < VAL_INT64(b);
+
+    if (IS_DECIMAL(a) && IS_DECIMAL(b))
+        return VAL_DECIMAL(a) < VAL_DECIMAL(b);
+
+    if (ANY_STRING(a) && VAL_TYPE(a) == VAL_TYPE(b))
+        return Compare_String_Vals(a, b, TRUE) < 0; // TRUE is uncased
+
+    // The general comparison can fail on some types
+
+    REBINT result;
+
+    internal::trapped("Values can't be compared for ordering", [&]() {
+        result = Cmp_Value(a, b, FALSE); // FALSE is not case-sensitive
+    });
+
+    return result < 0;
+}
+
+
+void AnyArray::sort() {
+    internal::checkWritable(cell);
+
+    REBARR * array = VAL_ARRAY(cell);
+    REBCNT head = VAL_INDEX(cell);
+    REBCNT len = VAL_LEN_AT(cell);
+    if (len < 2)
+        return;
+
+    bool integers = true;
+    bool decimals = true;
+    for (REBCNT n = 0; n < len; ++n) {
+        RELVAL const * item = ARR_AT(array, head + n);
+        integers = integers && IS_INTEGER(item);
+        decimals = decimals && IS_DECIMAL(item);
+    }
+
+    // Work out where each element goes, then move the cells once.  Ties are
+    // broken by position, so equal values keep their order.
+
+    std::vector<REBCNT> order (len);
+
+    if (integers) {
+        std::vector<std::pair<REBI64, REBCNT>> keys (len);
+        for (REBCNT n = 0; n < len; ++n)
+            keys[n] = std::make_pair(VAL_INT64(ARR_AT(array, head + n)), n);
+        std::sort(keys.begin(), keys.end());
+        for (REBCNT n = 0; n < len; ++n)
+            order[n] = keys[n].second;
+    }
+    else if (decimals) {
+        std::vector<std::pair<REBDEC, REBCNT>> keys (len);
+        for (REBCNT n = 0; n < len; ++n)
+            keys[n] = std::make_pair(VAL_DECIMAL(ARR_AT(array, head + n)), n);
+        std::sort(keys.begin(), keys.end());
+        for (REBCNT n = 0; n < len; ++n)
+            order[n] = keys[n].second;
+    }
+    else {
+        std::iota(order.begin(), order.end(), 0);
+
+        // Cmp_Value can fail, and its longjmp mustn't cross the frames of
+        // std::sort.  So each comparison is trapped on its own, and a failure
+        // leaves the sort as a C++ exception (with nothing moved yet).
+
+        RELVAL const * at = ARR_AT(array, head);
+        auto before = [at](REBCNT i, REBCNT j) -> bool {
+            REBINT result;
+            internal::trapped("Values can't be compared for ordering", [&]() {
+                result = Cmp_Value(at + i, at + j, FALSE);
+            });
+            return result < 0 || (result == 0 && i < j);
+        };
+
+        std::sort(order.begin(), order.end(), before);
+    }
+
+    // order[n] is the element that belongs at n; follow each cycle of the
+    // permutation with one cell held aside.
+
+    std::vector<bool> placed (len, false);
+    DECLARE_LOCAL (held);
+
+    for (REBCNT start = 0; start < len; ++start) {
+        if (placed[start] || order[start] == start) {
+            placed[start] = true;
+            continue;
+        }
+
+        Blit_Cell(held, ARR_AT(array, head + start));
+        REBCNT n = start;
+        while (true) {
+            placed[n] = true;
+            REBCNT from = order[n];
+            if (from == start) {
+                Blit_Cell(ARR_AT(array, head + n), held);
+                break;
+            }
+            Blit_Cell(ARR_AT(array, head + n), ARR_AT(array, head + from));
+            n = from;
+        }
+    }
+}
+
+
+
+//
+// MODIFICATION
+//
+
+void AnyArray::append(AnyValue const & value) {
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_ARRAY(VAL_ARRAY(cell));
+        Move_Value(Alloc_Tail_Array(VAL_ARRAY(cell)), value.cell);
+    });
+}
+
+
+void AnyArray::insert(size_t offset, AnyValue const & value) {
+    if (offset > VAL_LEN_AT(cell))
+        throw std::out_of_range("AnyArray::insert() offset past the tail");
+
+    REBCNT at = VAL_INDEX(cell) + static_cast<REBCNT>(offset);
+
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_ARRAY(VAL_ARRAY(cell));
+        Expand_Series(VAL_SERIES(cell), at, 1);
+        Move_Value(ARR_AT(VAL_ARRAY(cell), at), value.cell);
+    });
+}
+
+
+void AnyArray::poke(size_t offset, AnyValue const & value) {
+    if (offset >= VAL_LEN_AT(cell))
+        throw std::out_of_range("AnyArray::poke() offset past the tail");
+
+    begin()[static_cast<std::ptrdiff_t>(offset)] = value;
+}
+
+
+size_t AnyArray::find(AnyValue const & value) const {
+    REBCNT found;
+
+    internal::trapped("Values can't be compared in AnyArray::find()", [&]() {
+        found = Find_In_Array_Simple(
+            VAL_ARRAY(cell), VAL_INDEX(cell), value.cell
+        );
+    });
+
+    if (found >= VAL_LEN_HEAD(cell))
+        return npos;
+    return found - VAL_INDEX(cell);
+}
+
+
+
+//
+// EXTRACTION
+//
+
+namespace {
+
+template <class T>
+std::vector<T> & vectorOf(internal::Column const & column) {
+    return *static_cast<std::vector<T> *>(column.vector);
+}
+
+
+bad_value_cast wrongElement(
+    size_t offset,
+    size_t row,
+    size_t column,
+    char const * expected
+){
+    std::string message = "Array element at offset " + std::to_string(offset);
+    if (column != AnySeries::npos)
+        message += " (row " + std::to_string(row)
+            + ", column " + std::to_string(column) + ")";
+    message += " is not ";
+    message += expected;
+    return bad_value_cast(message);
+}
+
+} // end anonymous namespace
+
+
+void AnyArray::extractInto(
+    internal::Column const columns[],
+    size_t count
+) const {
+    using Kind = internal::Column::Kind;
+
+    size_t len = VAL_LEN_AT(cell);
+    if (len % count != 0)
+        throw bad_value_cast(
+            "Array of " + std::to_string(len) + " elements can't be split"
+            " into rows of " + std::to_string(count)
+        );
+
+    size_t rows = len / count;
+
+    for (size_t c = 0; c < count; ++c) {
+        switch (columns[c].kind) {
+        case Kind::Integer:
+            vectorOf<int64_t>(columns[c]).resize(rows);
+            break;
+
+        case Kind::Decimal:
+            vectorOf<double>(columns[c]).resize(rows);
+            break;
+
+        case Kind::String:
+            vectorOf<std::string>(columns[c]).resize(rows);
+            break;
+
+        default:
+            assert(false);
+        }
+    }
+
+    RELVAL const * item = ARR_AT(VAL_ARRAY(cell), VAL_INDEX(cell));
+    size_t offset = 0;
+
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < count; ++c, ++item, ++offset) {
+            // (Rows and columns are only mentioned if there's more than one)
+            //
+            size_t where = count == 1 ? npos : c;
+
+            switch (columns[c].kind) {
+            case Kind::Integer: {
+                if (!IS_INTEGER(item))
+                    throw wrongElement(offset, r, where, "an INTEGER!");
+
+                vectorOf<int64_t>(columns[c])[r] = VAL_INT64(item);
+                break; }
+
+            case Kind::Decimal: {
+                double & out = vectorOf<double>(columns[c])[r];
+
+                if (IS_DECIMAL(item))
+                    out = VAL_DECIMAL(item);
+                else if (IS_INTEGER(item))
+                    out = static_cast<double>(VAL_INT64(item));
+                else
+                    throw wrongElement(
+                        offset, r, where, "a DECIMAL! or INTEGER!"
+                    );
+                break; }
+
+            case Kind::String: {
+                if (!ANY_STRING(item))
+                    throw wrongElement(offset, r, where, "a string");
+
+                std::string & out = vectorOf<std::string>(columns[c])[r];
+
+                out.clear();
+                internal::appendUtf8(
+                    out, VAL_SERIES(item), VAL_INDEX(item), VAL_LEN_AT(item)
+                );
+                break; }
+
+            default:
+                assert(false);
+            }
+        }
+    }
+}
+
+
+
+//
+// BLOCKS OF ONE TYPE
+//
+
+namespace {
+
+size_t checkBlockOf(
+    REBVAL const * block,
+    enum Reb_Kind kind,
+    char const * expected
+){
+    size_t len = VAL_LEN_AT(block);
+    RELVAL const * item = ARR_AT(VAL_ARRAY(block), VAL_INDEX(block));
+
+    for (size_t offset = 0; offset < len; ++offset, ++item) {
+        if (VAL_TYPE(item) != kind)
+            throw wrongElement(offset, 0, AnySeries::npos, expected);
+    }
+    return len;
+}
+
+
+RELVAL const * blockOfAt(REBVAL const * block, size_t offset) {
+    return ARR_AT(
+        VAL_ARRAY(block), VAL_INDEX(block) + static_cast<REBCNT>(offset)
+    );
+}
+
+} // end anonymous namespace
+
+
+size_t internal::BlockOfElement<Integer>::check(Block const & block) {
+    return checkBlockOf(block.cell, REB_INTEGER, "an INTEGER!");
+}
+
+int64_t internal::BlockOfElement<Integer>::at(
+    Block const & block, size_t offset
+){
+    return VAL_INT64(blockOfAt(block.cell, offset));
+}
+
+
+size_t internal::BlockOfElement<Float>::check(Block const & block) {
+    return checkBlockOf(block.cell, REB_DECIMAL, "a DECIMAL!");
+}
+
+double internal::BlockOfElement<Float>::at(
+    Block const & block, size_t offset
+){
+    return VAL_DECIMAL(blockOfAt(block.cell, offset));
+}
+
+
+size_t internal::BlockOfElement<String>::check(Block const & block) {
+    return checkBlockOf(block.cell, REB_STRING, "a STRING!");
+}
+
+AnyString::Utf8View internal::BlockOfElement<String>::at(
+    Block const & block, size_t offset
+){
+    // (a RELVAL, which fromElement_() derelativizes)
+    //
+    return AnyValue::fromElement_<String>(
+        reinterpret_cast<REBVAL const *>(blockOfAt(block.cell, offset)),
+        block.cell,
+        block.origin
+    ).utf8View();
+}
+
+
+
 //
 // BLOCK CONSTRUCTION
 //
@@ -94,9 +548,10 @@ AnyArray::AnyArray (
 {
     (*cellfun)(this->cell);
 
-    AnyContext context = contextPtr
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
         ? *contextPtr
-        : AnyContext::current(engine);
+        : AnyContext::resolve(engine, found);
 
     constructOrApplyInitialize(
         context.getEngine(),
@@ -110,8 +565,6 @@ AnyArray::AnyArray (
 }
 
 
-// TBD: Finish version where you can use values directly as an array
-/*
 AnyArray::AnyArray (
     AnyValue const values[],
     size_t numValues,
@@ -121,24 +574,118 @@ AnyArray::AnyArray (
 ) :
     AnyArray (Dont::Initialize)
 {
-    (*cellfun)(this->cell);
+    // Values aren't bound or evaluated, so the context only says which
+    // engine the array belongs to
 
+    RenEngineHandle realEngine = contextPtr ? contextPtr->getEngine() :
+        (engine ? engine->getHandle() : Engine::runFinder().getHandle());
 
-    AnyContext context = contextPtr
-        ? *contextPtr
-        : AnyContext::current(engine);
+    internal::ArrayBuilder builder {numValues, realEngine};
+    for (size_t n = 0; n < numValues; ++n)
+        builder.add(values[n]);
 
-    constructOrApplyInitialize(
-        context.getEngine(),
-        &context,
-        nullptr, // no applicand
-        loadables,
-        numLoadables,
-        this, // Do construct
-        nullptr // Don't apply
-    );
+    adopt(builder, cellfun);
+}
+
+
+AnyArray::AnyArray (
+    internal::ArrayBuilder & builder,
+    internal::CellFunction cellfun
+) :
+    AnyArray (Dont::Initialize)
+{
+    adopt(builder, cellfun);
+}
+
+
+void AnyArray::adopt(
+    internal::ArrayBuilder & builder,
+    internal::CellFunction cellfun
+) {
+    if (!IS_BLOCK(builder.holder.cell))
+        throw std::runtime_error("ArrayBuilder can only make one array");
+
+    (*cellfun)(cell);
+    Init_Any_Array(cell, VAL_TYPE(cell), VAL_ARRAY(builder.holder.cell));
+    Init_Blank(builder.holder.cell);
+
+    finishInit(builder.engine);
+}
+
+
+
+//
+// ARRAY BUILDER
+//
+
+internal::ArrayBuilder::ArrayBuilder (size_t capacity, Engine * engine) :
+    ArrayBuilder (
+        capacity,
+        engine ? engine->getHandle() : Engine::runFinder().getHandle()
+    )
+{
+}
+
+
+internal::ArrayBuilder::ArrayBuilder (
+    size_t capacity,
+    RenEngineHandle engine
+) :
+    engine (engine)
+{
+    if (capacity >= std::numeric_limits<REBCNT>::max())
+        throw std::invalid_argument("Too many values for an array");
+
+    internal::trapped("Error making array (out of memory?)", [&]() {
+        REBARR * array = Make_Array(static_cast<REBCNT>(capacity));
+        MANAGE_ARRAY(array);
+        Init_Block(holder.cell, array);
+    });
+}
+
+
+// Alloc_Tail_Array() only fails if it has to grow the array and is out of
+// memory, and the Init_XXX() routines don't fail.  So those that don't make
+// a series aren't trapped.
+//
+void internal::ArrayBuilder::add(AnyValue const & value) {
+    Move_Value(Alloc_Tail_Array(VAL_ARRAY(holder.cell)), value.cell);
+}
+
+
+void internal::ArrayBuilder::add(bool logic) {
+    Init_Logic(Alloc_Tail_Array(VAL_ARRAY(holder.cell)), logic ? TRUE : FALSE);
+}
+
+
+void internal::ArrayBuilder::addInteger(int64_t integer) {
+    Init_Integer(Alloc_Tail_Array(VAL_ARRAY(holder.cell)), integer);
+}
+
+
+void internal::ArrayBuilder::addDecimal(double decimal) {
+    Init_Decimal(Alloc_Tail_Array(VAL_ARRAY(holder.cell)), decimal);
+}
+
+
+void internal::ArrayBuilder::add(char const * utf8) {
+    addText(utf8, strlen(utf8));
+}
+
+
+void internal::ArrayBuilder::addText(char const * utf8, size_t size) {
+    if (!internal::isValidUtf8(utf8, size))
+        throw std::runtime_error("Invalid UTF-8 passed to ArrayBuilder");
+
+    internal::trapped("Error making string (out of memory?)", [&]() {
+        // The array is managed, so the string is made managed too before it's
+        // put in (the GC could otherwise free it out from under the array)
+
+        REBSER * series = Make_Sized_String_UTF8(utf8, size);
+        MANAGE_SERIES(series);
+        Init_String(Alloc_Tail_Array(VAL_ARRAY(holder.cell)), series);
+    });
 }
-*/
 
 
 
@@ -211,5 +211,28 @@ bool Date::isValid(REBVAL const * cell) {
     return IS_DATE(cell);
 }
 
+Date::Date (std::string const & str, Engine * engine) :
+    Atom (Dont::Initialize)
+{
+    // Only the date lexer runs, not the whole scanner, and the text must
+    // be one date and nothing else (e.g. "14-Oct-2016" or "2016-10-14/10:00")
+
+    if (engine == nullptr)
+        engine = &Engine::runFinder();
+
+    const REBYTE *end;
+
+    internal::trapped("Date() given an out of range date", [&]() {
+        end = Scan_Date(
+            cell, cb_cast(str.data()), static_cast<REBCNT>(str.size())
+        );
+    });
+
+    if (end == NULL || end != cb_cast(str.data()) + str.size())
+        throw std::runtime_error("Date() given invalid date: " + str);
+
+    finishInit(engine->getHandle());
+}
+
 
 } // end namespace ren
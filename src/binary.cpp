@@ -0,0 +1,182 @@
+//
+// binary.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "rencpp/binary.hpp"
+#include "rencpp/engine.hpp"
+
+#include "common.hpp"
+
+#ifdef TO_WINDOWS
+    #include <fstream>
+#else
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace ren {
+
+//
+// TYPE DETECTION
+//
+
+bool Binary::isValid(REBVAL const * cell) {
+    return IS_BINARY(cell);
+}
+
+
+
+//
+// CONSTRUCTION
+//
+
+unsigned char * Binary::initBinary(size_t size, Engine * engine) {
+    if (size >= std::numeric_limits<REBCNT>::max())
+        throw std::invalid_argument("Too many bytes for a BINARY!");
+
+    REBSER * series;
+
+    internal::trapped("Error making BINARY! (out of memory?)", [&]() {
+        series = Make_Binary(static_cast<REBCNT>(size));
+    });
+
+    TERM_BIN_LEN(series, static_cast<REBCNT>(size));
+
+    Init_Binary(cell, series);
+    finishInit(
+        engine ? engine->getHandle() : Engine::runFinder().getHandle()
+    );
+
+    return BIN_HEAD(series);
+}
+
+
+Binary::Binary (unsigned char const * data, size_t size, Engine * engine) :
+    AnySeries (Dont::Initialize)
+{
+    unsigned char * bytes = initBinary(size, engine);
+    if (size != 0)
+        memcpy(bytes, data, size);
+}
+
+
+#ifndef TO_WINDOWS
+
+Binary Binary::readFile(std::string const & path, Engine * engine) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Binary couldn't open " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Binary couldn't stat " + path);
+    }
+
+    // Pipes (and files like those in /proc, which say their size is 0) are
+    // read until end of file, doubling the series whenever it fills up.  A
+    // file with a size is read into a series made at that size.
+
+    bool sized = S_ISREG(info.st_mode) && info.st_size > 0;
+    size_t capacity = sized ? static_cast<size_t>(info.st_size) : 4096;
+    size_t size = 0;
+
+    Binary result (Dont::Initialize);
+    try {
+        unsigned char * bytes = result.initBinary(capacity, engine);
+        REBSER * series = VAL_SERIES(result.cell);
+
+        while (true) {
+            if (size == capacity) {
+                if (sized)
+                    break;
+
+                if (capacity >= std::numeric_limits<REBCNT>::max() / 2) {
+                    throw std::invalid_argument(
+                        "Too many bytes for a BINARY!"
+                    );
+                }
+
+                result.reserve(capacity); // length is capacity, so doubles
+                capacity *= 2;
+                TERM_BIN_LEN(series, static_cast<REBCNT>(capacity));
+                bytes = BIN_HEAD(series);
+            }
+
+            ssize_t got = ::read(fd, bytes + size, capacity - size);
+            if (got == -1) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("Binary couldn't read " + path);
+            }
+            if (got == 0)
+                break;
+            size += static_cast<size_t>(got);
+        }
+
+        TERM_BIN_LEN(series, static_cast<REBCNT>(size));
+    }
+    catch (...) {
+        ::close(fd);
+        throw;
+    }
+
+    ::close(fd);
+    return result;
+}
+
+#else
+
+Binary Binary::readFile(std::string const & path, Engine * engine) {
+    std::ifstream file (path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("Binary couldn't open " + path);
+
+    size_t size = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    Binary result (Dont::Initialize);
+    unsigned char * bytes = result.initBinary(size, engine);
+    if (!file.read(
+        reinterpret_cast<char *>(bytes), static_cast<std::streamsize>(size)
+    )){
+        throw std::runtime_error("Binary couldn't read " + path);
+    }
+
+    return result;
+}
+
+#endif
+
+
+
+//
+// ELEMENT ACCESS
+//
+
+unsigned char * Binary::data() const {
+    return BIN_AT(VAL_SERIES(cell), VAL_INDEX(cell));
+}
+
+} // end namespace ren
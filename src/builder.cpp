@@ -0,0 +1,385 @@
+//
+// builder.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "rencpp/builder.hpp"
+#include "rencpp/engine.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// SERIES OPERATIONS
+//
+
+//
+// Anything that can allocate is done under a trap.  The series is managed
+// from the start (it's rooted by the builder's String), so if one of these
+// fails it's simply left as it was.
+//
+
+namespace {
+
+REBSER * seriesOf(void * series) {
+    return static_cast<REBSER *>(series);
+}
+
+
+void extendSeries(REBSER * series, size_t count) {
+    internal::trapped("Error growing StringBuilder (out of memory?)", [&]() {
+        Extend_Series(series, static_cast<REBCNT>(count));
+    });
+}
+
+
+void widenSeries(REBSER * series) {
+    internal::trapped("Error widening StringBuilder (out of memory?)", [&]() {
+        Widen_String(series, TRUE);
+    });
+}
+
+} // end anonymous namespace
+
+
+
+//
+// CONSTRUCTION AND GROWTH
+//
+
+StringBuilder::StringBuilder (size_t reserve, Engine * engine) :
+    engine (engine),
+    series (nullptr),
+    data (nullptr),
+    wide (1),
+    used (0),
+    capacity (0),
+    pendingSize (0),
+    buffer (*this),
+    out (&buffer)
+{
+    if (reserve != 0)
+        this->reserve(reserve);
+}
+
+
+void StringBuilder::start() {
+    if (engine == nullptr)
+        engine = &Engine::runFinder();
+
+    DECLARE_LOCAL (cell);
+
+    internal::trapped("Error starting StringBuilder (out of memory?)", [&]() {
+        // A byte-sized series, as the interpreter makes for Latin-1 strings
+
+        Init_String(cell, Make_Binary(64));
+    });
+
+    target = AnyValue::fromCell_<String>(cell, engine->getHandle());
+
+    series = VAL_SERIES(cell);
+    data = SER_DATA_RAW(seriesOf(series));
+    wide = 1;
+    used = 0;
+    capacity = SER_REST(seriesOf(series)) - 1; // room for the terminator
+}
+
+
+void StringBuilder::reserve(size_t count) {
+    if (!target)
+        start();
+    if (capacity - used < count)
+        reserveMore(count);
+}
+
+
+void StringBuilder::reserveMore(size_t count) {
+    // Double, or more if one append needs more than that
+
+    REBSER * s = seriesOf(series);
+    SET_SERIES_LEN(s, static_cast<REBCNT>(used));
+    extendSeries(s, std::max(count + 1, capacity + 1));
+
+    data = SER_DATA_RAW(s);
+    capacity = SER_REST(s) - 1;
+}
+
+
+void StringBuilder::widen() {
+    REBSER * s = seriesOf(series);
+    SET_SERIES_LEN(s, static_cast<REBCNT>(used));
+    widenSeries(s);
+
+    data = SER_DATA_RAW(s);
+    wide = SER_WIDE(s);
+    capacity = SER_REST(s) - 1;
+}
+
+
+// There must be room for one more character
+//
+void StringBuilder::put(uint32_t codepoint) {
+    if (wide == 1) {
+        if (codepoint > 0xFF) {
+            widen();
+            if (capacity == used)
+                reserveMore(1);
+            put(codepoint);
+            return;
+        }
+        data[used++] = static_cast<unsigned char>(codepoint);
+        return;
+    }
+
+    unsigned char * at = data + used * wide;
+    if (wide == 2) {
+        if (codepoint > 0xFFFF)
+            throw std::runtime_error(
+                "StringBuilder character outside the interpreter's range"
+            );
+        uint16_t unit = static_cast<uint16_t>(codepoint);
+        memcpy(at, &unit, sizeof(unit));
+    }
+    else
+        memcpy(at, &codepoint, sizeof(codepoint));
+    ++used;
+}
+
+
+
+//
+// APPENDING
+//
+
+void StringBuilder::appendUtf8(char const * utf8, size_t size, bool partial) {
+    auto bytes = reinterpret_cast<unsigned char const *>(utf8);
+
+    // There are never more characters than bytes
+    //
+    reserve(size);
+
+    size_t i = 0;
+    while (i < size) {
+        // Runs of ASCII go straight into a byte-sized series
+
+        if (wide == 1) {
+            size_t run = i;
+            while (run < size && bytes[run] < 0x80)
+                ++run;
+            memcpy(data + used, bytes + i, run - i);
+            used += run - i;
+            i = run;
+            if (i == size)
+                break;
+        }
+
+        char32_t codepoint;
+        bool truncated;
+        size_t length = internal::decodeUtf8(
+            codepoint, bytes + i, size - i, &truncated
+        );
+
+        if (length == 0) {
+            if (partial && truncated) {
+                memcpy(pending, bytes + i, size - i); // finish on next write
+                pendingSize = size - i;
+                return;
+            }
+            throw std::runtime_error("Invalid UTF-8 passed to StringBuilder");
+        }
+
+        put(codepoint);
+        i += length;
+    }
+}
+
+
+StringBuilder & StringBuilder::append(char const * utf8, size_t size) {
+    appendUtf8(utf8, size, false);
+    return *this;
+}
+
+
+StringBuilder & StringBuilder::append(char const * utf8) {
+    return append(utf8, strlen(utf8));
+}
+
+
+StringBuilder & StringBuilder::appendChar(char32_t codepoint) {
+    if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+        throw std::runtime_error("Invalid codepoint passed to StringBuilder");
+
+    reserve(1);
+    put(codepoint);
+    return *this;
+}
+
+
+StringBuilder & StringBuilder::appendInteger(int64_t value) {
+    char digits[24];
+    char * at = digits + sizeof(digits);
+
+    // Negate as unsigned, so the most negative value doesn't overflow
+    //
+    uint64_t magnitude = value < 0
+        ? ~static_cast<uint64_t>(value) + 1
+        : static_cast<uint64_t>(value);
+
+    do {
+        *--at = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+        *--at = '-';
+
+    return append(at, static_cast<size_t>(digits + sizeof(digits) - at));
+}
+
+
+StringBuilder & StringBuilder::appendFormed(AnyValue const & value) {
+    REBSER * formed;
+
+    internal::trapped("Error in StringBuilder FORM (stack overflow?)", [&]() {
+        DECLARE_MOLD (mo);
+        Push_Mold(mo);
+        Form_Value(mo, value.cell);
+        formed = Pop_Molded_String(mo);
+    });
+
+    // Copied a character at a time, as its width may differ from ours
+
+    try {
+        REBCNT len = SER_LEN(formed);
+        reserve(len);
+        for (REBCNT n = 0; n < len; ++n)
+            put(GET_ANY_CHAR(formed, n));
+    }
+    catch (...) {
+        Free_Series(formed);
+        throw;
+    }
+
+    Free_Series(formed);
+    return *this;
+}
+
+
+
+//
+// FINISHING
+//
+
+String StringBuilder::finish() {
+    out.flush();
+
+    // A write the builder refused (invalid UTF-8) sets badbit, after which
+    // the stream ignores everything.  Clear it either way, and drop what was
+    // built, so the failure doesn't carry over to the next string.
+
+    if (out.bad()) {
+        out.clear();
+        reset();
+        throw std::runtime_error("Invalid UTF-8 written to StringBuilder");
+    }
+
+    if (pendingSize != 0) {
+        pendingSize = 0;
+        throw std::runtime_error("StringBuilder stream ended mid-character");
+    }
+
+    if (!target)
+        start();
+
+    REBSER * s = seriesOf(series);
+    SET_SERIES_LEN(s, static_cast<REBCNT>(used));
+    TERM_SEQUENCE(s);
+
+    String result = *target;
+    reset();
+    return result;
+}
+
+
+void StringBuilder::reset() {
+    target = nullopt;
+    series = nullptr;
+    data = nullptr;
+    wide = 1;
+    used = 0;
+    capacity = 0;
+    pendingSize = 0;
+}
+
+
+
+//
+// STREAM ADAPTER
+//
+
+StringBuilder::Buffer::Buffer (StringBuilder & builder) :
+    builder (builder)
+{
+    setp(space, space + sizeof(space));
+}
+
+
+StringBuilder::Buffer::int_type StringBuilder::Buffer::overflow(int_type c) {
+    if (sync() != 0)
+        return traits_type::eof();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+
+int StringBuilder::Buffer::sync() {
+    // Bytes left over from a split sequence go in front of the new ones
+
+    try {
+        size_t size = static_cast<size_t>(pptr() - pbase());
+        if (builder.pendingSize != 0 && size != 0) {
+            unsigned char joined[4 + sizeof(space)];
+            memcpy(joined, builder.pending, builder.pendingSize);
+            memcpy(joined + builder.pendingSize, pbase(), size);
+            size += builder.pendingSize;
+            builder.pendingSize = 0;
+            builder.appendUtf8(
+                reinterpret_cast<char const *>(joined), size, true
+            );
+        }
+        else if (size != 0)
+            builder.appendUtf8(pbase(), size, true);
+    }
+    catch (...) {
+        setp(space, space + sizeof(space));
+        return -1; // sets badbit on the stream
+    }
+
+    setp(space, space + sizeof(space));
+    return 0;
+}
+
+} // end namespace ren
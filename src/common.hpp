@@ -37,6 +37,11 @@
     #include <signal.h> // needed for SIGINT, SIGTERM, SIGHUP
 #endif
 
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "rebol/src/include/sys-core.h"
 
 
@@ -50,4 +55,205 @@ extern REBOOL Generalized_Apply_Throws(
     REBSPC *specifier
 );
 
+
+// Natives which Ren-C++ adds to the lib context during initialization (see
+// RebolRuntime::lazyInitializeIfNecessary).  The dispatchers live in the
+// files for the features they belong to.
+
+namespace ren {
+namespace internal {
+
+void addLibNative(char const * name, char const * spec, REBNAT dispatcher);
+
+REB_R Parallel_Map_Native(struct Reb_Frame *frame_);
+
+
+// Decodes the character at the start of `bytes` (of which there are `size`,
+// at least one) into `codepoint`, returning how many bytes it took.  If the
+// bytes aren't valid UTF-8--a stray continuation byte, an overlong form, a
+// surrogate, a codepoint past U+10FFFF, or a sequence cut off by the end--0
+// is returned.  If `truncated` is given it says whether the problem was only
+// the cut-off, so text arriving in pieces can wait for the rest.
+
+inline size_t decodeUtf8(
+    char32_t & codepoint,
+    unsigned char const * bytes,
+    size_t size,
+    bool * truncated = nullptr
+){
+    if (truncated)
+        *truncated = false;
+
+    unsigned char lead = bytes[0];
+    if (lead < 0x80) {
+        codepoint = lead;
+        return 1;
+    }
+
+    size_t trail;
+    char32_t lowest;
+
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        trail = 1;
+        codepoint = lead & 0x1Fu;
+        lowest = 0x80;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        trail = 2;
+        codepoint = lead & 0x0Fu;
+        lowest = 0x800;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+        trail = 3;
+        codepoint = lead & 0x07u;
+        lowest = 0x10000;
+    }
+    else
+        return 0; // stray continuation byte, or C0/C1/F5..FF
+
+    size_t available = size - 1 < trail ? size - 1 : trail;
+    for (size_t n = 1; n <= available; ++n) {
+        unsigned char c = bytes[n];
+        if ((c & 0xC0u) != 0x80u)
+            return 0;
+        codepoint = (codepoint << 6) | (c & 0x3Fu);
+    }
+
+    if (available < trail) {
+        if (truncated)
+            *truncated = true;
+        return 0;
+    }
+
+    if (
+        codepoint < lowest
+        || codepoint > 0x10FFFF
+        || (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+    ){
+        return 0;
+    }
+
+    return trail + 1;
+}
+
+
+// Checked before C++ text is copied into a series, and used to copy the
+// text of a string series out (see %strings.cpp)
+
+bool isValidUtf8(char const * data, size_t size);
+
+void appendUtf8(std::string & out, REBSER * series, REBCNT index, REBCNT len);
+
+void appendUtf8(
+    std::vector<unsigned char> & out,
+    REBSER * series,
+    REBCNT index,
+    REBCNT len
+);
+
+
+// Runs `body` under a trap, turning a `fail` inside it into a C++ exception
+// with the message `what`.  Since `fail` longjmps back to this frame, the
+// body must not make any C++ objects with destructors, or call into C++
+// code (like std::sort) that has frames of its own for the jump to cross.
+// A C++ exception thrown by the body drops the trap on its way out.
+
+template <class F>
+void trapped(char const * what, F && body) {
+    REBCTX *error;
+    struct Reb_State state;
+
+    PUSH_UNHALTABLE_TRAP(&error, &state);
+
+// The first time through the following code 'error' will be NULL, but...
+// `fail` can longjmp here, so 'error' won't be NULL *if* that happens!
+
+    if (error != NULL)
+        throw std::runtime_error(what);
+
+    try {
+        body();
+    }
+    catch (...) {
+        DROP_TRAP_SAME_STACKLEVEL_AS_PUSH(&state);
+        throw;
+    }
+
+    DROP_TRAP_SAME_STACKLEVEL_AS_PUSH(&state);
+}
+
+
+// The other direction, for natives written in C++: exceptions can't unwind
+// through the evaluator, so `body` runs in a try block that catches them
+// all.  The message is copied into a plain buffer, and the fail() happens
+// after the body's scope (and any C++ objects in it) has been left.  `what`
+// is the message for exceptions that aren't std::exception.  The native
+// calling this must not have C++ objects with destructors on its own stack.
+
+void failWithMessage(char const * message); // see %errors.cpp
+
+template <class F>
+void failOnThrow(char const * what, F && body) {
+    char message[256];
+    message[0] = '\0';
+
+    try {
+        body();
+    }
+    catch (std::exception const & e) {
+        strncpy(message, e.what(), sizeof(message) - 1);
+        message[sizeof(message) - 1] = '\0';
+        if (message[0] == '\0')
+            strncpy(message, what, sizeof(message) - 1);
+    }
+    catch (...) {
+        strncpy(message, what, sizeof(message) - 1);
+        message[sizeof(message) - 1] = '\0';
+    }
+
+    if (message[0] != '\0')
+        failWithMessage(message);
+}
+
+
+// Lets go of the spellings kept for Symbols, before the runtime shuts down
+// (see %words.cpp)
+
+void forgetSymbols();
+
+
+// Throws std::runtime_error if the series (or array) in the cell may not be
+// modified, e.g. it's been PROTECTed (see %series.cpp)
+
+void checkWritable(REBVAL const * series);
+
+
+// Makes an INTEGER! or DECIMAL! of a VECTOR! element (see %vector.cpp)
+
+void initVectorElement(REBVAL * out, REBVAL const * vector, REBCNT index);
+
+
+// String search natives (see %search.cpp)
+
+REB_R Find_Text_Native(struct Reb_Frame *frame_);
+REB_R Find_Any_Char_Native(struct Reb_Frame *frame_);
+REB_R Count_Char_Native(struct Reb_Frame *frame_);
+REB_R Count_Lines_Native(struct Reb_Frame *frame_);
+REB_R Split_Text_Native(struct Reb_Frame *frame_);
+
+
+// Numeric reduction natives (see %reduce.cpp)
+
+REB_R Sum_Of_Native(struct Reb_Frame *frame_);
+REB_R Min_Of_Native(struct Reb_Frame *frame_);
+REB_R Max_Of_Native(struct Reb_Frame *frame_);
+REB_R Mean_Of_Native(struct Reb_Frame *frame_);
+REB_R Variance_Of_Native(struct Reb_Frame *frame_);
+REB_R Dot_Product_Native(struct Reb_Frame *frame_);
+REB_R Prefix_Sum_Native(struct Reb_Frame *frame_);
+REB_R Histogram_Native(struct Reb_Frame *frame_);
+
+} // end namespace internal
+} // end namespace ren
+
 #endif // RENCPP_REBOL_COMMON_HPP
@@ -18,7 +18,7 @@
 
 #include <cassert>
 #include <stdexcept>
-#include <stdexcept>
+#include <utility>
 
 #include "rencpp/value.hpp"
 #include "rencpp/engine.hpp"
@@ -32,6 +32,10 @@ namespace ren {
 
 AnyContext::Finder AnyContext::finder;
 
+thread_local AnyContext const * AnyContext::scoped = nullptr;
+
+thread_local AnyContext const * AnyContext::cachedUser = nullptr;
+
 
 
 AnyContext AnyContext::lookup(const char * name, Engine * engine)
@@ -50,17 +54,36 @@ AnyContext AnyContext::lookup(const char * name, Engine * engine)
 
 
 
-AnyContext AnyContext::current(Engine * engine) {
-    if (finder == nullptr) {
-        finder = [] (Engine * engine) -> AnyContext & {
-            if (engine == nullptr)
-                engine = &Engine::runFinder();
-
-            static AnyContext user = lookup("USER", engine);
-            return user;
-        };
+AnyContext const & AnyContext::user(Engine * engine) {
+    if (engine == nullptr)
+        engine = &Engine::runFinder();
+
+    static AnyContext user = lookup("USER", engine);
+    return user;
+}
+
+
+AnyContext const & AnyContext::resolve(
+    Engine * engine,
+    optional<AnyContext> & holder
+) {
+    if (scoped != nullptr)
+        return *scoped;
+
+    if (finder != nullptr) {
+        holder = finder(engine);
+        return *holder;
     }
-    return finder(engine);
+
+    if (cachedUser == nullptr)
+        cachedUser = &user(engine);
+    return *cachedUser;
+}
+
+
+AnyContext AnyContext::current(Engine * engine) {
+    optional<AnyContext> holder;
+    return resolve(engine, holder);
 }
 
 
@@ -106,9 +129,14 @@ AnyContext::AnyContext (
 }
 
 
-// TBD: Finish version where you can use values directly as an array
-/*
-
+// Values are taken as word/value pairs, neither bound nor evaluated:
+//
+//     AnyValue fields[] = {Word {"x"}, Integer {10}, Word {"y"}, Integer {20}};
+//     Object point (fields, 4, nullptr); // like make object! [x: 10 y: 20]
+//
+// Only objects are made this way; an ERROR! has fields that must be checked,
+// so it goes through the evaluator.
+//
 AnyContext::AnyContext (
     AnyValue const values[],
     size_t numValues,
@@ -120,22 +148,53 @@ AnyContext::AnyContext (
 {
     (*cellfun)(this->cell);
 
-    // Here, a null context pointer means null.  No finder is invoked.
+    if (VAL_TYPE(this->cell) != REB_OBJECT)
+        throw std::invalid_argument(
+            "Only objects can be made from values without evaluation"
+        );
+
+    if (numValues % 2 != 0)
+        throw std::invalid_argument(
+            "Object values must be word/value pairs"
+        );
+
+    for (size_t n = 0; n < numValues; n += 2) {
+        if (!ANY_WORD(values[n].cell))
+            throw std::invalid_argument(
+                "Object values must be word/value pairs"
+            );
+    }
 
     RenEngineHandle realEngine = contextPtr ? contextPtr->getEngine() :
         (engine ? engine->getHandle() : Engine::runFinder().getHandle());
 
-    constructOrApplyInitialize(
-        realEngine,
-        nullptr, // no applicand
-        loadables,
-        numLoadables,
-        this, // Do construct
-        nullptr // Don't apply
-    );
-}
+    internal::trapped("Error making object (out of memory?)", [&]() {
+        REBCTX * context = Alloc_Context(
+            REB_OBJECT, static_cast<REBCNT>(numValues / 2)
+        );
+
+        for (size_t n = 0; n < numValues; n += 2) {
+            REBSTR * spelling = VAL_WORD_SPELLING(values[n].cell);
+
+            // A word given twice takes the last value, as with MAKE OBJECT!
+
+            REBCNT index = Find_Canon_In_Context(
+                context, STR_CANON(spelling), FALSE
+            );
+            REBVAL * var = index != 0
+                ? CTX_VAR(context, index)
+                : Append_Context(context, NULL, spelling);
+
+            Move_Value(var, values[n + 1].cell);
+        }
+
+        MANAGE_ARRAY(CTX_KEYLIST(context));
+        MANAGE_ARRAY(CTX_VARLIST(context));
+        Init_Any_Context(this->cell, REB_OBJECT, context);
+    });
 
-*/
+    finishInit(realEngine);
+}
 
 //
 // TYPE HEADER INITIALIZATION
@@ -150,4 +209,119 @@ void AnyContext::initError(REBVAL *cell) {
 }
 
 
+
+//
+// CONTEXT POOL
+//
+
+ContextPool::ContextPool (Object const & templateObject, size_t count) :
+    warm (AnyValue::fromCell_<Object>(
+        static_cast<AnyValue const &>(templateObject).copy(false).cell,
+        templateObject.origin
+    ))
+{
+    // Extend the copy with every word in lib that it doesn't already have,
+    // so code run in the pooled contexts finds its words already there.
+    // (Keeps the template's own values for any words it defines.)
+
+    internal::trapped("Couldn't resolve ContextPool template", [&]() {
+        DECLARE_LOCAL (allWords);
+        Init_Blank(allWords);
+
+        Resolve_Context(
+            VAL_CONTEXT(warm.cell),
+            Lib_Context,
+            allWords,
+            FALSE, // !all, don't overwrite the template's values
+            TRUE // expand
+        );
+    });
+
+    idle.reserve(count);
+    for (size_t n = 0; n < count; ++n)
+        idle.push_back(clone());
+}
+
+
+Object ContextPool::clone() const {
+    AnyValue copied = static_cast<AnyValue const &>(warm).copy(false);
+    return AnyValue::fromCell_<Object>(copied.cell, copied.origin);
+}
+
+
+// Only possible if the context still shares the template's keylist, so the
+// variables line up one for one.  It doesn't if code run in it added words,
+// or PROTECTed or hid a variable: those set flags on the keys, so the
+// keylist is copied first.  Only the variables' values are copied back, so a
+// context that was PROTECTed as a whole can't be reset either.
+//
+bool ContextPool::reset(Object const & context) const noexcept {
+    REBCTX * c = VAL_CONTEXT(context.cell);
+    REBCTX * w = VAL_CONTEXT(warm.cell);
+
+    if (CTX_KEYLIST(c) != CTX_KEYLIST(w))
+        return false;
+
+    REBSER * varlist = SER(CTX_VARLIST(c));
+    if (
+        GET_SER_INFO(varlist, SERIES_INFO_PROTECTED)
+        || GET_SER_INFO(varlist, SERIES_INFO_FROZEN)
+    ){
+        return false;
+    }
+
+    REBCNT len = CTX_LEN(w);
+    for (REBCNT n = 1; n <= len; ++n)
+        Move_Value(CTX_VAR(c, n), CTX_VAR(w, n));
+    return true;
+}
+
+
+// Runs when leases are destroyed, so it can't throw.  If a replacement for a
+// context that couldn't be reset can't be made, the context is just dropped;
+// acquire() makes a new one when the pool runs out.
+//
+void ContextPool::giveBack(Object && context) noexcept {
+    try {
+        if (!reset(context))
+            context = clone();
+
+        std::lock_guard<std::mutex> guard (mutex);
+        idle.push_back(std::move(context));
+    }
+    catch (...) {
+    }
+}
+
+
+ContextPool::Lease ContextPool::acquire() {
+    {
+        std::lock_guard<std::mutex> guard (mutex);
+        if (!idle.empty()) {
+            Object context = std::move(idle.back());
+            idle.pop_back();
+            return Lease {*this, std::move(context)};
+        }
+    }
+    return Lease {*this, clone()};
+}
+
+
+size_t ContextPool::available() const {
+    std::lock_guard<std::mutex> guard (mutex);
+    return idle.size();
+}
+
+
+void ContextPool::Lease::release() noexcept {
+    if (!pool)
+        return;
+
+    ContextPool * owner = pool;
+    pool = nullptr;
+    owner->giveBack(std::move(*context));
+    context = nullopt;
+}
+
+
 } // end namespace ren
@@ -24,6 +24,16 @@ namespace ren {
 
 Engine::Finder Engine::finder;
 
+thread_local Engine * Engine::scoped = nullptr;
+
+thread_local Engine * Engine::cachedGlobal = nullptr;
+
+
+Engine & Engine::global() {
+    static Engine engine;
+    return engine;
+}
+
 
 std::ostream & Engine::setOutputStream(std::ostream & os) {
     auto temp = osPtr;
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <stdexcept>
 
 #include "rencpp/value.hpp"
@@ -26,35 +27,36 @@ bool Error::isValid(REBVAL const * cell) {
 Error::Error (const char * msg, Engine * engine) :
     AnyContext_ (Dont::Initialize)
 {
-    VAL_RESET_HEADER(cell, REB_ERROR);
+    // The message is made into the error directly, as MAKE ERROR! of a
+    // string would, instead of being LOADed as part of an error literal.
+    // So a message with braces in it doesn't need escaping.
+
+    if (!internal::isValidUtf8(msg, strlen(msg)))
+        throw std::runtime_error("Invalid UTF-8 passed to Error()");
 
     if (engine == nullptr)
         engine = &Engine::runFinder();
 
-    std::string array (
-        "#[error! [code: _ type: 'User id: 'message message: "
-    );
+    internal::trapped("Error making ERROR! (out of memory?)", [&]() {
+        // the shim could adjust the where and say what function threw it?
+        // file/line number optional?
+
+        Init_Error(cell, Error_User(msg));
+    });
 
-    array += '{';
-    array += msg;
-    array += '}';
+    finishInit(engine->getHandle());
+}
 
-    // the shim could adjust the where and say what function threw it?
-    // file/line number optional?
 
-    array += "]]";
 
-    internal::Loadable loadable = array.data();
+//
+// RAISING FROM NATIVES
+//
 
-    constructOrApplyInitialize(
-        engine->getHandle(),
-        nullptr, // no context
-        nullptr, // no applicand
-        &loadable,
-        1,
-        this, // Do construct
-        nullptr // Don't apply
-    );
+void internal::failWithMessage(char const * message) {
+    DECLARE_LOCAL (what);
+    Init_String(what, Make_UTF8_May_Fail(cb_cast(message)));
+    fail (::Error(RE_USER, what));
 }
 
 } // end namespace ren
@@ -0,0 +1,291 @@
+//
+// executor.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include "rencpp/executor.hpp"
+#include "rencpp/engine.hpp"
+#include "rencpp/rebol.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// SHARED LOCK STATE
+//
+
+//
+// A plain std::mutex can't express "wait until the lock is free *and* the
+// frame stack is back to where I left it", so the lock is a flag guarded by
+// a mutex and condition variable.  `resuming` holds the frames of threads
+// blocked in ~Unlocked, which new acquirers defer to when one of them is
+// ready to go.
+//
+
+namespace {
+
+struct LockState {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool held;
+    std::thread::id owner;
+    std::vector<Reb_Frame *> resuming;
+};
+
+LockState & lockState() {
+    static LockState state {}; // thread-safe initialization in C++11
+    return state;
+}
+
+thread_local bool holdsLock = false;
+
+thread_local int unlockedDepth = 0;
+
+} // end anonymous namespace
+
+
+EvaluatorLock::EvaluatorLock () {
+    assert(!holdsLock); // not recursive
+    assert(unlockedDepth == 0); // can't evaluate inside an Unlocked scope
+
+    LockState & state = lockState();
+    std::unique_lock<std::mutex> guard (state.mutex);
+
+    state.changed.wait(guard, [&]() -> bool {
+        if (state.held)
+            return false;
+        return std::find(
+            state.resuming.begin(), state.resuming.end(), FS_TOP
+        ) == state.resuming.end();
+    });
+
+    state.held = true;
+    state.owner = std::this_thread::get_id();
+    holdsLock = true;
+}
+
+
+EvaluatorLock::~EvaluatorLock () {
+    LockState & state = lockState();
+    {
+        std::lock_guard<std::mutex> guard (state.mutex);
+        assert(state.held && state.owner == std::this_thread::get_id());
+        state.held = false;
+        state.owner = std::thread::id {};
+        holdsLock = false;
+    }
+    state.changed.notify_all();
+}
+
+
+bool EvaluatorLock::isHeld() {
+    return holdsLock;
+}
+
+
+
+//
+// UNLOCKED
+//
+
+Unlocked::Unlocked () :
+    active (false),
+    frame (nullptr),
+    stackLimit (nullptr)
+{
+    LockState & state = lockState();
+    {
+        std::lock_guard<std::mutex> guard (state.mutex);
+
+        if (!state.held) {
+            // Nobody is using the lock, so there's no one to let in.  Count
+            // the depth anyway, so debug checks still catch value creation.
+            //
+            ++unlockedDepth;
+            return;
+        }
+
+        // A native running on one thread while another holds the lock means
+        // two threads are in the evaluator at once.
+        //
+        assert(holdsLock && state.owner == std::this_thread::get_id());
+
+        active = true;
+        frame = FS_TOP;
+        stackLimit = Stack_Limit;
+
+        state.held = false;
+        state.owner = std::thread::id {};
+        holdsLock = false;
+        ++unlockedDepth;
+    }
+    state.changed.notify_all();
+}
+
+
+Unlocked::~Unlocked () {
+    --unlockedDepth;
+    if (!active)
+        return;
+
+    LockState & state = lockState();
+    std::unique_lock<std::mutex> guard (state.mutex);
+
+    Reb_Frame * suspended = reinterpret_cast<Reb_Frame *>(frame);
+    state.resuming.push_back(suspended);
+    state.changed.notify_all(); // acquirers must re-check who is ready
+
+    state.changed.wait(guard, [&]() -> bool {
+        return !state.held && FS_TOP == suspended;
+    });
+
+    state.resuming.erase(
+        std::find(state.resuming.begin(), state.resuming.end(), suspended)
+    );
+
+    state.held = true;
+    state.owner = std::this_thread::get_id();
+    holdsLock = true;
+
+    // Evaluations on other threads will have set the stack limit for their
+    // own C stacks when they pushed their traps.
+    //
+    Stack_Limit = stackLimit;
+}
+
+
+bool Unlocked::isActiveOnThisThread() {
+    return unlockedDepth != 0;
+}
+
+
+
+//
+// EXECUTOR
+//
+
+Executor::Executor (size_t numThreads) :
+    closing (false)
+{
+    if (numThreads == 0)
+        throw std::runtime_error("Executor needs at least one thread");
+
+    // Boot the engine here rather than racing to do it from the workers.
+    //
+    Engine::runFinder();
+
+    for (size_t n = 0; n < numThreads; ++n)
+        threads.emplace_back(&Executor::run, this);
+}
+
+
+void Executor::run() {
+    while (true) {
+        Entry entry;
+
+        {
+            std::unique_lock<std::mutex> guard (mutex);
+            ready.wait(guard, [&]() -> bool {
+                return closing || !queue.empty();
+            });
+            if (queue.empty())
+                return; // closing, and nothing left to do
+
+            entry = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        // Exceptions thrown by the job are captured into the future by the
+        // packaged_task, so there's nothing to catch here.  The task is
+        // dropped before the lock, since the callable may hold values.
+        {
+            EvaluatorLock lock;
+            entry.task();
+            entry.task = std::packaged_task<optional<AnyValue>()> {};
+        }
+
+        if (entry.then)
+            entry.then();
+    }
+}
+
+
+std::future<optional<AnyValue>> Executor::submit(
+    Job job,
+    std::function<void()> then
+) {
+    Entry entry;
+    entry.task = std::packaged_task<optional<AnyValue>()> {std::move(job)};
+    entry.then = std::move(then);
+    auto future = entry.task.get_future();
+
+    {
+        std::lock_guard<std::mutex> guard (mutex);
+        if (closing)
+            throw std::runtime_error("Executor has been closed");
+        queue.push_back(std::move(entry));
+    }
+    ready.notify_one();
+
+    return future;
+}
+
+
+std::future<optional<AnyValue>> Executor::submit(Job job) {
+    return submit(std::move(job), nullptr);
+}
+
+
+std::future<optional<AnyValue>> Executor::submit(std::string const & source) {
+    return submit([source]() -> optional<AnyValue> {
+        return runtime(source.c_str());
+    });
+}
+
+
+size_t Executor::pending() const {
+    std::lock_guard<std::mutex> guard (mutex);
+    return queue.size();
+}
+
+
+void Executor::close() {
+    assert(!EvaluatorLock::isHeld()); // workers would wait on us forever
+
+    {
+        std::lock_guard<std::mutex> guard (mutex);
+        closing = true;
+    }
+    ready.notify_all();
+
+    for (auto & thread : threads)
+        if (thread.joinable())
+            thread.join();
+    threads.clear();
+}
+
+
+Executor::~Executor () {
+    close();
+}
+
+} // end namespace ren
@@ -0,0 +1,310 @@
+//
+// parallel.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "rencpp/parallel.hpp"
+#include "rencpp/engine.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// WORK-STEALING POOL
+//
+
+//
+// The pool is made on first use and lives until exit.  A parallelFor() call
+// divides its range into one slice per participating thread (the calling
+// thread included), and each thread takes chunks off the front of its own
+// slice with an atomic increment.  A thread whose slice is used up moves on
+// to take chunks from the other slices, so a slow chunk on one thread does
+// not leave the rest idle.
+//
+// Only one parallelFor() at a time gets the pool.  A second caller (e.g. an
+// Executor thread that got in while the first was Unlocked) just runs its
+// range serially rather than waiting.
+//
+
+namespace {
+
+struct Slice {
+    std::atomic<size_t> next;
+    size_t end;
+    char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+
+struct Job {
+    std::function<void(size_t, size_t)> const * body;
+    size_t chunk;
+    size_t numSlices;
+    std::unique_ptr<Slice[]> slices;
+
+    std::atomic<size_t> nextParticipant;
+    std::atomic<bool> failed;
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    void work() {
+        size_t self = nextParticipant.fetch_add(1);
+        if (self >= numSlices)
+            return;
+
+        for (size_t n = 0; n < numSlices && !failed.load(); ++n) {
+            Slice & slice = slices[(self + n) % numSlices];
+            while (!failed.load()) {
+                size_t begin = slice.next.fetch_add(chunk);
+                if (begin >= slice.end)
+                    break;
+                try {
+                    (*body)(begin, std::min(begin + chunk, slice.end));
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock (errorMutex);
+                    if (!error)
+                        error = std::current_exception();
+                    failed.store(true);
+                }
+            }
+        }
+    }
+};
+
+
+class WorkerPool {
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::vector<std::thread> threads;
+
+    Job * job;
+    uint64_t generation;
+    size_t running;
+    bool stopping;
+
+    std::mutex inUse;
+
+    void run() {
+        uint64_t seen = 0;
+        while (true) {
+            Job * current;
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                wake.wait(lock, [&]() -> bool {
+                    return stopping || generation != seen;
+                });
+                if (stopping)
+                    return;
+                seen = generation;
+                current = job;
+            }
+
+            current->work();
+
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                --running;
+            }
+            finished.notify_all();
+        }
+    }
+
+public:
+    WorkerPool () :
+        job (nullptr),
+        generation (0),
+        running (0),
+        stopping (false)
+    {
+        size_t hardware = std::thread::hardware_concurrency();
+        for (size_t n = 1; n < hardware; ++n) // calling thread is the other
+            threads.emplace_back(&WorkerPool::run, this);
+    }
+
+    ~WorkerPool () {
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto & thread : threads)
+            thread.join();
+    }
+
+    size_t size() const { return threads.size() + 1; }
+
+    bool tryRun(Job & newJob) {
+        std::unique_lock<std::mutex> busy (inUse, std::try_to_lock);
+        if (!busy.owns_lock())
+            return false;
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            job = &newJob;
+            ++generation;
+            running = threads.size();
+        }
+        wake.notify_all();
+
+        newJob.work();
+
+        std::unique_lock<std::mutex> lock (mutex);
+        finished.wait(lock, [&]() -> bool { return running == 0; });
+        job = nullptr;
+        return true;
+    }
+};
+
+
+WorkerPool & workerPool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+} // end anonymous namespace
+
+
+void internal::parallelFor(
+    size_t count,
+    std::function<void(size_t begin, size_t end)> const & body,
+    size_t numThreads
+) {
+    // Below this it costs more to wake the pool than to just do the work
+    //
+    const size_t serialLimit = 2048;
+
+    WorkerPool & pool = workerPool();
+
+    size_t numSlices = numThreads == 0
+        ? pool.size()
+        : std::min(numThreads, pool.size());
+
+    if (count < serialLimit || numSlices <= 1) {
+        if (count != 0)
+            body(0, count);
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.numSlices = numSlices;
+    job.chunk = std::max<size_t>(count / (numSlices * 16), 256);
+    job.slices.reset(new Slice[numSlices]);
+    job.nextParticipant.store(0);
+    job.failed.store(false);
+
+    size_t per = count / numSlices;
+    for (size_t n = 0; n < numSlices; ++n) {
+        job.slices[n].next.store(n * per);
+        job.slices[n].end = (n == numSlices - 1) ? count : (n + 1) * per;
+    }
+
+    if (!pool.tryRun(job)) {
+        body(0, count);
+        return;
+    }
+
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+
+
+//
+// KERNEL REGISTRY AND PARALLEL-MAP NATIVE
+//
+
+namespace {
+
+std::mutex kernelsMutex;
+
+std::map<std::string, internal::ParallelKernel> & kernels() {
+    static std::map<std::string, internal::ParallelKernel> registry;
+    return registry;
+}
+
+} // end anonymous namespace
+
+
+void internal::registerParallelKernel(
+    std::string const & name,
+    ParallelKernel kernel
+) {
+    std::lock_guard<std::mutex> lock (kernelsMutex);
+    kernels()[name] = std::move(kernel);
+}
+
+
+void internal::ParallelMapper::applyKernel(
+    REBVAL * out,
+    REBVAL const * series,
+    std::string const & name
+) {
+    ParallelKernel kernel;
+    {
+        std::lock_guard<std::mutex> lock (kernelsMutex);
+        auto it = kernels().find(name);
+        if (it == kernels().end())
+            throw std::runtime_error(
+                "No C++ kernel registered for PARALLEL-MAP named " + name
+            );
+        kernel = it->second;
+    }
+
+    AnyArray array = AnyValue::fromCell_<AnyArray>(
+        series, Engine::runFinder().getHandle()
+    );
+
+    Block result = kernel(array);
+    Move_Value(out, result.cell);
+}
+
+
+REB_R internal::Parallel_Map_Native(struct Reb_Frame *frame_) {
+    PARAM(1, series);
+    PARAM(2, kernel);
+
+    internal::failOnThrow(
+        "Unknown C++ exception in PARALLEL-MAP kernel",
+        [&]() {
+            REBSTR * spelling = VAL_WORD_SPELLING(ARG(kernel));
+            internal::ParallelMapper::applyKernel(
+                D_OUT,
+                ARG(series),
+                std::string {STR_HEAD(spelling), STR_SIZE(spelling)}
+            );
+        }
+    );
+
+    return R_OUT;
+}
+
+} // end namespace ren
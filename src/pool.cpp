@@ -0,0 +1,615 @@
+//
+// pool.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "rencpp/pool.hpp"
+#include "rencpp/arrays.hpp"
+#include "rencpp/engine.hpp"
+#include "rencpp/error.hpp"
+#include "rencpp/rebol.hpp"
+
+#include "common.hpp"
+
+#ifndef TO_WINDOWS
+    #include <signal.h>
+    #include <sys/socket.h>
+    #include <sys/types.h>
+    #include <sys/uio.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+
+namespace ren {
+
+#ifndef TO_WINDOWS
+
+//
+// LOW-LEVEL SOCKET HELPERS
+//
+
+//
+// The worker sockets are SOCK_STREAM, so reads and writes can come back
+// short and have to be looped.  A false result means the other side is gone
+// (or something else went wrong badly enough that it may as well be).
+//
+
+static bool readAll(int fd, void * buffer, size_t size) {
+    auto bytes = reinterpret_cast<char *>(buffer);
+    while (size != 0) {
+        ssize_t n = ::read(fd, bytes, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+
+static bool writeAll(int fd, void const * buffer, size_t size) {
+    auto bytes = reinterpret_cast<char const *>(buffer);
+    while (size != 0) {
+        // A worker that crashed would SIGPIPE us on write if we did not ask
+        // for the error code instead.
+        //
+    #ifdef MSG_NOSIGNAL
+        ssize_t n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    #else
+        ssize_t n = ::send(fd, bytes, size, 0);
+    #endif
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+
+//
+// Messages are framed with a 32-bit length, so a payload can't be larger
+// than 4 GiB.  Callers check the size before sending.
+//
+
+static size_t const maxMessage = UINT32_MAX;
+
+static bool writeMessage(int fd, std::string const & payload) {
+    assert(payload.size() <= maxMessage);
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    return writeAll(fd, &length, sizeof(length))
+        && writeAll(fd, payload.data(), payload.size());
+}
+
+
+static bool readMessage(int fd, std::string & payload) {
+    uint32_t length;
+    if (!readAll(fd, &length, sizeof(length)))
+        return false;
+    payload.resize(length);
+    return length == 0 || readAll(fd, &payload[0], length);
+}
+
+
+//
+// Passing a file descriptor between processes requires an SCM_RIGHTS control
+// message.  One data byte always goes along with it so the receiver can tell
+// a failed fork (no descriptor attached) apart from the zygote going away.
+//
+
+static bool sendFd(int socket, int fd) {
+    char marker = fd == -1 ? 'X' : 'F';
+
+    struct iovec iov;
+    iov.iov_base = &marker;
+    iov.iov_len = 1;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    union {
+        struct cmsghdr align; // CMSG_DATA must be suitably aligned
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    if (fd != -1) {
+        memset(&control, 0, sizeof(control));
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    return ::sendmsg(socket, &msg, 0) == 1;
+}
+
+
+static int recvFd(int socket) {
+    char marker;
+
+    struct iovec iov;
+    iov.iov_base = &marker;
+    iov.iov_len = 1;
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t n;
+    do {
+        n = ::recvmsg(socket, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+
+    if (n != 1 || marker != 'F')
+        return -1;
+
+    struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+    if (
+        cmsg == nullptr
+        || cmsg->cmsg_level != SOL_SOCKET
+        || cmsg->cmsg_type != SCM_RIGHTS
+    ){
+        return -1;
+    }
+
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
+}
+
+
+
+//
+// WORKER AND ZYGOTE PROCESSES
+//
+
+//
+// MOLD/ALL is used instead of FORM so that what the parent loads back is
+// the same value, e.g. a STRING! stays a STRING! and doesn't get scanned
+// as a WORD!.  The construction syntax of /ALL covers things like OBJECT!
+// which would otherwise mold as `make object! [...]` and need evaluating.
+//
+
+std::string EnginePool::moldAsUtf8(AnyValue const & value) {
+    REBSER * utf8_series;
+
+    internal::trapped("Error during MOLD in EnginePool worker", [&]() {
+        DECLARE_MOLD (mo);
+        SET_MOLD_FLAG(mo, MOLD_FLAG_ALL);
+
+        Push_Mold(mo);
+        Mold_Value(mo, value.cell);
+
+        utf8_series = Pop_Molded_UTF8(mo);
+    });
+
+    std::string result (
+        cs_cast(BIN_HEAD(utf8_series)),
+        static_cast<size_t>(SER_LEN(utf8_series))
+    );
+    Free_Series(utf8_series);
+    return result;
+}
+
+
+void EnginePool::runWorker(int fd) {
+    std::string source;
+
+    while (readMessage(fd, source)) {
+        Status status;
+        std::string payload;
+
+        try {
+            optional<AnyValue> result = runtime(source.c_str());
+            if (result) {
+                status = Status::Value;
+                payload = moldAsUtf8(*result);
+            }
+            else
+                status = Status::NoValue;
+        }
+        catch (load_error const & e) {
+            status = Status::LoadError;
+            payload = e.what();
+        }
+        catch (evaluation_error const & e) {
+            status = Status::EvaluationError;
+            payload = e.what();
+        }
+        catch (std::exception const & e) {
+            status = Status::OtherError; // includes THROW and halts
+            payload = e.what();
+        }
+
+        if (payload.size() > maxMessage) {
+            status = Status::OtherError;
+            payload = "EnginePool result is over 4 GiB, too large to send";
+        }
+
+        auto statusByte = static_cast<unsigned char>(status);
+        if (
+            !writeAll(fd, &statusByte, 1)
+            || !writeMessage(fd, payload)
+        ){
+            break;
+        }
+    }
+
+    // Parent closed its end (or went away), so there's no one left to serve.
+    // Skip the atexit() handlers, which belong to the parent's lifetime.
+    //
+    _exit(0);
+}
+
+
+void EnginePool::runZygote(int controlFd) {
+    //
+    // Workers are not our concern once their socket has been handed off, so
+    // let the kernel reap them instead of accumulating zombies.
+    //
+    signal(SIGCHLD, SIG_IGN);
+
+    char command;
+    while (readAll(controlFd, &command, 1)) {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            sendFd(controlFd, -1);
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            //
+            // Worker scripts may CALL processes and wait on them, which
+            // fails if children are reaped automatically.
+            //
+            signal(SIGCHLD, SIG_DFL);
+
+            ::close(controlFd);
+            ::close(fds[0]);
+            runWorker(fds[1]);
+        }
+
+        ::close(fds[1]);
+        sendFd(controlFd, pid < 0 ? -1 : fds[0]);
+        ::close(fds[0]);
+    }
+
+    _exit(0);
+}
+
+
+
+//
+// POOL CONSTRUCTION AND DISPATCH
+//
+
+EnginePool::EnginePool (size_t numWorkers, char const * startupCode) :
+    numRestarts (0),
+    zygoteFd (-1),
+    zygotePid (-1)
+{
+    if (numWorkers == 0)
+        throw std::runtime_error("EnginePool needs at least one worker");
+
+    // Boot the engine and run the startup code here, so that every worker
+    // inherits the result without paying for it again.
+    //
+    Engine::runFinder();
+    if (startupCode)
+        runtime(startupCode);
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        throw std::runtime_error("EnginePool couldn't create control socket");
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error("EnginePool couldn't fork zygote process");
+    }
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        runZygote(fds[1]);
+    }
+
+    ::close(fds[1]);
+    zygoteFd = fds[0];
+    zygotePid = static_cast<long>(pid);
+
+    workers.resize(numWorkers);
+    for (auto & worker : workers) {
+        worker.busy = false;
+        worker.fd = -1;
+    }
+
+    for (auto & worker : workers) {
+        worker.fd = spawnWorker();
+        if (worker.fd == -1) {
+            //
+            // The destructor won't run if the constructor throws, so the
+            // workers started so far and the zygote are shut down here.
+            //
+            close();
+            throw std::runtime_error(
+                "EnginePool couldn't fork worker process"
+            );
+        }
+    }
+}
+
+
+int EnginePool::spawnWorker() {
+    if (zygoteFd == -1)
+        return -1;
+
+    char command = 'F';
+    if (!writeAll(zygoteFd, &command, 1))
+        return -1;
+
+    return recvFd(zygoteFd);
+}
+
+
+size_t EnginePool::restarts() const {
+    std::lock_guard<std::mutex> lock (mutex);
+    return numRestarts;
+}
+
+
+EnginePool::Status EnginePool::transact(
+    std::string const & source,
+    std::string & payloadOut
+) {
+    if (source.size() > maxMessage)
+        throw std::runtime_error(
+            "EnginePool request is over 4 GiB, too large to send"
+        );
+
+    size_t index = 0;
+    int fd;
+
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+
+        idle.wait(lock, [&]() -> bool {
+            if (zygoteFd == -1)
+                return true; // closed, let the check below throw
+            for (index = 0; index < workers.size(); ++index)
+                if (!workers[index].busy)
+                    return true;
+            return false;
+        });
+
+        if (zygoteFd == -1)
+            throw std::runtime_error("EnginePool has been closed");
+
+        // A previous replacement may have failed to fork; try again now.
+        //
+        if (workers[index].fd == -1) {
+            workers[index].fd = spawnWorker();
+            if (workers[index].fd == -1)
+                throw std::runtime_error("EnginePool couldn't fork worker");
+            ++numRestarts;
+        }
+
+        workers[index].busy = true;
+        fd = workers[index].fd;
+    }
+
+    bool sent = writeMessage(fd, source);
+
+    if (!sent) {
+        // The worker died while it was idle, so the request never reached
+        // it.  Replace the worker and send the request once more, to the new
+        // one.  (Only a failure after that is blamed on the request.)
+        //
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+
+            ::close(fd);
+            fd = workers[index].fd = spawnWorker();
+            ++numRestarts;
+
+            if (fd == -1)
+                workers[index].busy = false; // next transact() tries again
+        }
+
+        if (fd == -1) {
+            idle.notify_one();
+            throw std::runtime_error("EnginePool couldn't fork worker");
+        }
+
+        sent = writeMessage(fd, source);
+    }
+
+    unsigned char statusByte = 0;
+    bool ok = sent
+        && readAll(fd, &statusByte, 1)
+        && readMessage(fd, payloadOut);
+
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        if (!ok) {
+            // Whatever the script did took the worker process down with it.
+            // Replace it from the zygote, which still has the clean state.
+            //
+            ::close(fd);
+            workers[index].fd = spawnWorker();
+            ++numRestarts;
+        }
+        workers[index].busy = false;
+    }
+    idle.notify_one();
+
+    if (!ok)
+        throw std::runtime_error(
+            "EnginePool worker died during evaluation (it was restarted)"
+        );
+
+    if (statusByte > static_cast<unsigned char>(Status::OtherError))
+        throw std::runtime_error("EnginePool worker sent a bad response");
+
+    return static_cast<Status>(statusByte);
+}
+
+
+optional<std::string> EnginePool::evaluateMolded(std::string const & source) {
+    std::string payload;
+
+    switch (transact(source, payload)) {
+    case Status::Value:
+        return payload;
+
+    case Status::NoValue:
+        return nullopt;
+
+    default: // LoadError, EvaluationError, OtherError
+        throw std::runtime_error(payload);
+    }
+}
+
+
+optional<AnyValue> EnginePool::evaluate(std::string const & source) {
+    std::string payload;
+
+    switch (transact(source, payload)) {
+    case Status::Value: {
+        // The Loadable splices what it scans into the block, so the single
+        // molded value will be the first (and only) element.
+        //
+        Block loaded {payload.c_str()};
+        if (loaded.length() != 1)
+            throw std::runtime_error("EnginePool result did not reload");
+        return static_cast<AnyValue>(*loaded.begin());
+    }
+
+    case Status::NoValue:
+        return nullopt;
+
+    case Status::LoadError:
+        throw load_error {Error {payload.c_str()}};
+
+    case Status::EvaluationError:
+        throw evaluation_error {Error {payload.c_str()}};
+
+    default: // OtherError
+        throw std::runtime_error(payload);
+    }
+}
+
+
+void EnginePool::close() {
+    std::lock_guard<std::mutex> lock (mutex);
+
+    if (zygoteFd == -1)
+        return;
+
+    // Workers exit when they see EOF on their socket, and so does the zygote
+
+    for (auto & worker : workers) {
+        if (worker.fd != -1)
+            ::close(worker.fd);
+        worker.fd = -1;
+    }
+
+    ::close(zygoteFd);
+    zygoteFd = -1;
+
+    int status;
+    auto pid = static_cast<pid_t>(zygotePid);
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR)
+        continue;
+
+    idle.notify_all();
+}
+
+
+EnginePool::~EnginePool () {
+    try {
+        close();
+    }
+    catch (...) {
+        // destructors should not throw
+    }
+}
+
+#else // TO_WINDOWS
+
+//
+// There is no fork() on Windows, and the zygote technique doesn't translate.
+// A version based on spawning processes and re-running the startup code
+// could be done, but it would lose the point of sharing warm boot pages.
+//
+
+EnginePool::EnginePool (size_t, char const *) :
+    numRestarts (0),
+    zygoteFd (-1),
+    zygotePid (-1)
+{
+    throw std::runtime_error("EnginePool requires a POSIX fork()");
+}
+
+size_t EnginePool::restarts() const {
+    return numRestarts;
+}
+
+optional<std::string> EnginePool::evaluateMolded(std::string const &) {
+    UNREACHABLE_CODE();
+}
+
+optional<AnyValue> EnginePool::evaluate(std::string const &) {
+    UNREACHABLE_CODE();
+}
+
+void EnginePool::close() {
+}
+
+EnginePool::~EnginePool () {
+}
+
+#endif
+
+} // end namespace ren
@@ -0,0 +1,807 @@
+//
+// reduce.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define REN_REDUCE_SSE2 1
+#else
+    #define REN_REDUCE_SSE2 0
+#endif
+
+#include "rencpp/value.hpp"
+#include "rencpp/arrays.hpp"
+#include "rencpp/reduce.hpp"
+#include "rencpp/engine.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// CHECKING AND UNBOXING
+//
+
+//
+// An array's cells are much bigger than the numbers in them, and the number
+// isn't at the start of the cell, so the kernels can't run over the cells.
+// Instead the numbers are copied out a chunk at a time into a buffer on the
+// stack, which stays in the cache, and the kernels run over that.  Their
+// types were all checked beforehand, so the copying doesn't check them.
+//
+
+namespace {
+
+struct Numbers {
+    RELVAL const * head;
+    size_t len;
+    bool integers; // all INTEGER!, else decimals (and integers are widened)
+};
+
+
+Numbers numbersOf(REBVAL const * array) {
+    Numbers numbers {
+        ARR_AT(VAL_ARRAY(array), VAL_INDEX(array)),
+        VAL_LEN_AT(array),
+        true
+    };
+
+    RELVAL const * item = numbers.head;
+    for (size_t n = 0; n < numbers.len; ++n, ++item) {
+        if (IS_DECIMAL(item))
+            numbers.integers = false;
+        else if (!IS_INTEGER(item))
+            throw bad_value_cast(
+                "Array element at offset " + std::to_string(n)
+                + " is not an INTEGER! or DECIMAL!"
+            );
+    }
+    return numbers;
+}
+
+
+const size_t chunkSize = 256;
+
+
+size_t unbox(Numbers const & numbers, size_t start, int64_t * out) {
+    size_t count = std::min(chunkSize, numbers.len - start);
+    RELVAL const * item = numbers.head + start;
+    for (size_t n = 0; n < count; ++n, ++item)
+        out[n] = VAL_INT64(item);
+    return count;
+}
+
+
+size_t unbox(Numbers const & numbers, size_t start, double * out) {
+    size_t count = std::min(chunkSize, numbers.len - start);
+    RELVAL const * item = numbers.head + start;
+    for (size_t n = 0; n < count; ++n, ++item)
+        out[n] = IS_INTEGER(item)
+            ? static_cast<double>(VAL_INT64(item))
+            : VAL_DECIMAL(item);
+    return count;
+}
+
+
+// Calls `kernel(buffer, count)` for each chunk of the numbers
+//
+template <class T, class Kernel>
+void forChunks(Numbers const & numbers, Kernel && kernel) {
+    T buffer[chunkSize];
+    size_t start = 0;
+    while (start < numbers.len) {
+        size_t count = unbox(numbers, start, buffer);
+        kernel(static_cast<T const *>(buffer), count);
+        start += count;
+    }
+}
+
+} // end anonymous namespace
+
+
+
+//
+// KERNELS
+//
+
+//
+// SSE2 has 64-bit integer adds but no 64-bit integer compares or multiplies,
+// so integer sums are vectorized and the other integer kernels are plain
+// loops.  A lane of an integer sum has overflowed if the sign of its result
+// differs from the signs of both things added.  That's checked for the whole
+// chunk at the end, and if it happened the chunk is added up again in order,
+// which only overflows if adding them up one by one would.
+//
+// Decimal kernels keep four partial results in two registers, so that each
+// addition doesn't wait on the one before it.
+//
+
+namespace {
+
+// False if it overflows
+//
+bool tryAdd(int64_t a, int64_t b, int64_t & result) {
+#if defined(__GNUC__)
+    return !__builtin_add_overflow(a, b, &result);
+#else
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+        return false;
+    result = a + b;
+    return true;
+#endif
+}
+
+
+int64_t addChecked(int64_t a, int64_t b) {
+    int64_t result;
+    if (!tryAdd(a, b, result))
+        throw std::overflow_error("Integer overflow");
+    return result;
+}
+
+
+int64_t multiplyChecked(int64_t a, int64_t b) {
+#if defined(__GNUC__)
+    int64_t result;
+    if (__builtin_mul_overflow(a, b, &result))
+        throw std::overflow_error("Integer overflow");
+    return result;
+#else
+    bool overflow = a > 0
+        ? (b > 0 ? a > INT64_MAX / b : b < INT64_MIN / a)
+        : (b > 0 ? a < INT64_MIN / b : (a != 0 && b < INT64_MAX / a));
+    if (overflow)
+        throw std::overflow_error("Integer overflow");
+    return a * b;
+#endif
+}
+
+
+int64_t sumIntegers(int64_t const * p, size_t count, int64_t total) {
+    size_t n = 0;
+
+#if REN_REDUCE_SSE2
+    __m128i lanes = _mm_setzero_si128();
+    __m128i overflow = _mm_setzero_si128();
+    for (; n + 2 <= count; n += 2) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + n));
+        __m128i sum = _mm_add_epi64(lanes, x);
+        overflow = _mm_or_si128(
+            overflow,
+            _mm_and_si128(_mm_xor_si128(lanes, sum), _mm_xor_si128(x, sum))
+        );
+        lanes = sum;
+    }
+
+    int64_t parts[2];
+    int64_t signs[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(parts), lanes);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(signs), overflow);
+
+    int64_t lanesTotal;
+    int64_t newTotal;
+    if (
+        (signs[0] | signs[1]) < 0
+        || !tryAdd(parts[0], parts[1], lanesTotal)
+        || !tryAdd(total, lanesTotal, newTotal)
+    ){
+        n = 0; // overflowed, but adding in order might not
+    }
+    else
+        total = newTotal;
+#endif
+
+    for (; n < count; ++n)
+        total = addChecked(total, p[n]);
+    return total;
+}
+
+
+double sumDecimals(double const * p, size_t count) {
+    double total = 0;
+    size_t n = 0;
+
+#if REN_REDUCE_SSE2
+    __m128d a = _mm_setzero_pd();
+    __m128d b = _mm_setzero_pd();
+    for (; n + 4 <= count; n += 4) {
+        a = _mm_add_pd(a, _mm_loadu_pd(p + n));
+        b = _mm_add_pd(b, _mm_loadu_pd(p + n + 2));
+    }
+
+    double parts[2];
+    _mm_storeu_pd(parts, _mm_add_pd(a, b));
+    total = parts[0] + parts[1];
+#endif
+
+    for (; n < count; ++n)
+        total += p[n];
+    return total;
+}
+
+
+double sumSquaredDeviations(double const * p, size_t count, double mean) {
+    double total = 0;
+    size_t n = 0;
+
+#if REN_REDUCE_SSE2
+    __m128d m = _mm_set1_pd(mean);
+    __m128d a = _mm_setzero_pd();
+    __m128d b = _mm_setzero_pd();
+    for (; n + 4 <= count; n += 4) {
+        __m128d x = _mm_sub_pd(_mm_loadu_pd(p + n), m);
+        __m128d y = _mm_sub_pd(_mm_loadu_pd(p + n + 2), m);
+        a = _mm_add_pd(a, _mm_mul_pd(x, x));
+        b = _mm_add_pd(b, _mm_mul_pd(y, y));
+    }
+
+    double parts[2];
+    _mm_storeu_pd(parts, _mm_add_pd(a, b));
+    total = parts[0] + parts[1];
+#endif
+
+    for (; n < count; ++n)
+        total += (p[n] - mean) * (p[n] - mean);
+    return total;
+}
+
+
+double dotDecimals(double const * p, double const * q, size_t count) {
+    double total = 0;
+    size_t n = 0;
+
+#if REN_REDUCE_SSE2
+    __m128d a = _mm_setzero_pd();
+    __m128d b = _mm_setzero_pd();
+    for (; n + 4 <= count; n += 4) {
+        a = _mm_add_pd(
+            a, _mm_mul_pd(_mm_loadu_pd(p + n), _mm_loadu_pd(q + n))
+        );
+        b = _mm_add_pd(
+            b, _mm_mul_pd(_mm_loadu_pd(p + n + 2), _mm_loadu_pd(q + n + 2))
+        );
+    }
+
+    double parts[2];
+    _mm_storeu_pd(parts, _mm_add_pd(a, b));
+    total = parts[0] + parts[1];
+#endif
+
+    for (; n < count; ++n)
+        total += p[n] * q[n];
+    return total;
+}
+
+
+int64_t dotIntegers(
+    int64_t const * p,
+    int64_t const * q,
+    size_t count,
+    int64_t total
+){
+    for (size_t n = 0; n < count; ++n)
+        total = addChecked(total, multiplyChecked(p[n], q[n]));
+    return total;
+}
+
+
+void extremesOfDecimals(
+    double const * p,
+    size_t count,
+    double & low,
+    double & high
+){
+    size_t n = 0;
+
+#if REN_REDUCE_SSE2
+    __m128d lo = _mm_set1_pd(low);
+    __m128d hi = _mm_set1_pd(high);
+    for (; n + 2 <= count; n += 2) {
+        __m128d x = _mm_loadu_pd(p + n);
+        lo = _mm_min_pd(lo, x);
+        hi = _mm_max_pd(hi, x);
+    }
+
+    double parts[2];
+    _mm_storeu_pd(parts, lo);
+    low = std::min(parts[0], parts[1]);
+    _mm_storeu_pd(parts, hi);
+    high = std::max(parts[0], parts[1]);
+#endif
+
+    for (; n < count; ++n) {
+        low = std::min(low, p[n]);
+        high = std::max(high, p[n]);
+    }
+}
+
+
+void extremesOfIntegers(
+    int64_t const * p,
+    size_t count,
+    int64_t & low,
+    int64_t & high
+){
+    for (size_t n = 0; n < count; ++n) {
+        low = std::min(low, p[n]);
+        high = std::max(high, p[n]);
+    }
+}
+
+} // end anonymous namespace
+
+
+
+//
+// REDUCTIONS
+//
+
+//
+// These are shared by the C++ interface and the natives, so they work on
+// cells.  They may throw, so they don't make any series; building result
+// blocks is left to the callers, who know whether they're under a trap.
+//
+
+namespace {
+
+struct Number {
+    bool integer;
+    int64_t i;
+    double d;
+};
+
+
+void initNumber(RELVAL * out, Number const & number) {
+    if (number.integer)
+        Init_Integer(out, number.i);
+    else
+        Init_Decimal(out, number.d);
+}
+
+
+Number sumOf(REBVAL const * array) {
+    Numbers numbers = numbersOf(array);
+
+    if (numbers.integers) {
+        int64_t total = 0;
+        forChunks<int64_t>(numbers, [&](int64_t const * p, size_t count) {
+            total = sumIntegers(p, count, total);
+        });
+        return Number {true, total, 0};
+    }
+
+    double total = 0;
+    forChunks<double>(numbers, [&](double const * p, size_t count) {
+        total += sumDecimals(p, count);
+    });
+    return Number {false, 0, total};
+}
+
+
+// False if there are no numbers
+//
+bool extremesOf(REBVAL const * array, Number & low, Number & high) {
+    Numbers numbers = numbersOf(array);
+    if (numbers.len == 0)
+        return false;
+
+    if (numbers.integers) {
+        int64_t lo = VAL_INT64(numbers.head);
+        int64_t hi = lo;
+        forChunks<int64_t>(numbers, [&](int64_t const * p, size_t count) {
+            extremesOfIntegers(p, count, lo, hi);
+        });
+        low = Number {true, lo, 0};
+        high = Number {true, hi, 0};
+        return true;
+    }
+
+    double lo = IS_INTEGER(numbers.head)
+        ? static_cast<double>(VAL_INT64(numbers.head))
+        : VAL_DECIMAL(numbers.head);
+    double hi = lo;
+    forChunks<double>(numbers, [&](double const * p, size_t count) {
+        extremesOfDecimals(p, count, lo, hi);
+    });
+    low = Number {false, 0, lo};
+    high = Number {false, 0, hi};
+    return true;
+}
+
+
+double meanOf(Numbers const & numbers) {
+    if (numbers.len == 0)
+        throw std::domain_error("Mean of no numbers");
+
+    double total = 0;
+    forChunks<double>(numbers, [&](double const * p, size_t count) {
+        total += sumDecimals(p, count);
+    });
+    return total / static_cast<double>(numbers.len);
+}
+
+
+double varianceOf(REBVAL const * array, bool sample) {
+    Numbers numbers = numbersOf(array);
+    if (numbers.len == 0 || (sample && numbers.len < 2))
+        throw std::domain_error("Too few numbers for a variance");
+
+    // Two passes (the mean, then the squares of the differences from it)
+    // loses much less precision than summing the squares in one pass
+
+    double mean = meanOf(numbers);
+    double total = 0;
+    forChunks<double>(numbers, [&](double const * p, size_t count) {
+        total += sumSquaredDeviations(p, count, mean);
+    });
+    return total / static_cast<double>(sample ? numbers.len - 1 : numbers.len);
+}
+
+
+Number dotOf(REBVAL const * left, REBVAL const * right) {
+    Numbers p = numbersOf(left);
+    Numbers q = numbersOf(right);
+    if (p.len != q.len)
+        throw std::invalid_argument("Dot product of arrays of unequal length");
+
+    if (p.integers && q.integers) {
+        int64_t x[chunkSize];
+        int64_t y[chunkSize];
+        int64_t total = 0;
+        for (size_t start = 0; start < p.len; start += chunkSize) {
+            size_t count = unbox(p, start, x);
+            unbox(q, start, y);
+            total = dotIntegers(x, y, count, total);
+        }
+        return Number {true, total, 0};
+    }
+
+    double x[chunkSize];
+    double y[chunkSize];
+    double total = 0;
+    for (size_t start = 0; start < p.len; start += chunkSize) {
+        size_t count = unbox(p, start, x);
+        unbox(q, start, y);
+        total += dotDecimals(x, y, count);
+    }
+    return Number {false, 0, total};
+}
+
+
+// Fills one of the vectors, and says which
+//
+bool prefixSumsOf(
+    REBVAL const * array,
+    std::vector<int64_t> & integers,
+    std::vector<double> & decimals
+){
+    Numbers numbers = numbersOf(array);
+
+    if (numbers.integers) {
+        integers.reserve(numbers.len);
+        int64_t total = 0;
+        forChunks<int64_t>(numbers, [&](int64_t const * p, size_t count) {
+            for (size_t n = 0; n < count; ++n) {
+                total = addChecked(total, p[n]);
+                integers.push_back(total);
+            }
+        });
+        return true;
+    }
+
+    decimals.reserve(numbers.len);
+    double total = 0;
+    forChunks<double>(numbers, [&](double const * p, size_t count) {
+        for (size_t n = 0; n < count; ++n) {
+            total += p[n];
+            decimals.push_back(total);
+        }
+    });
+    return false;
+}
+
+
+std::vector<int64_t> histogramOf(
+    REBVAL const * array,
+    double low,
+    double high,
+    size_t buckets
+){
+    if (buckets == 0)
+        throw std::invalid_argument("A histogram needs at least one bucket");
+    if (!(low < high) || std::isinf(low) || std::isinf(high))
+        throw std::invalid_argument("Histogram range must be low to high");
+
+    Numbers numbers = numbersOf(array);
+
+    std::vector<int64_t> counts (buckets, 0);
+    double scale = static_cast<double>(buckets) / (high - low);
+
+    forChunks<double>(numbers, [&](double const * p, size_t count) {
+        for (size_t n = 0; n < count; ++n) {
+            if (!(p[n] >= low && p[n] <= high))
+                continue; // outside the range (or NaN)
+
+            size_t bucket = static_cast<size_t>((p[n] - low) * scale);
+            ++counts[std::min(bucket, buckets - 1)];
+        }
+    });
+    return counts;
+}
+
+
+template <class T>
+Block blockOf(std::vector<T> const & values, RenEngineHandle engine) {
+    internal::ArrayBuilder builder {values.size(), engine};
+    for (T value : values)
+        builder.add(value);
+    return Block {builder};
+}
+
+} // end anonymous namespace
+
+
+
+//
+// C++ INTERFACE
+//
+
+AnyValue sum(AnyArray const & numbers) {
+    Number total = sumOf(internal::Reduction::cellOf(numbers));
+
+    DECLARE_LOCAL (out);
+    initNumber(out, total);
+    return internal::Reduction::fromCell<AnyValue>(out, numbers);
+}
+
+
+optional<AnyValue> minimum(AnyArray const & numbers) {
+    Number low;
+    Number high;
+    if (!extremesOf(internal::Reduction::cellOf(numbers), low, high))
+        return nullopt;
+
+    DECLARE_LOCAL (out);
+    initNumber(out, low);
+    return internal::Reduction::fromCell<AnyValue>(out, numbers);
+}
+
+
+optional<AnyValue> maximum(AnyArray const & numbers) {
+    Number low;
+    Number high;
+    if (!extremesOf(internal::Reduction::cellOf(numbers), low, high))
+        return nullopt;
+
+    DECLARE_LOCAL (out);
+    initNumber(out, high);
+    return internal::Reduction::fromCell<AnyValue>(out, numbers);
+}
+
+
+double mean(AnyArray const & numbers) {
+    return meanOf(numbersOf(internal::Reduction::cellOf(numbers)));
+}
+
+
+double variance(AnyArray const & numbers, bool sample) {
+    return varianceOf(internal::Reduction::cellOf(numbers), sample);
+}
+
+
+AnyValue dot(AnyArray const & left, AnyArray const & right) {
+    Number total = dotOf(
+        internal::Reduction::cellOf(left),
+        internal::Reduction::cellOf(right)
+    );
+
+    DECLARE_LOCAL (out);
+    initNumber(out, total);
+    return internal::Reduction::fromCell<AnyValue>(out, left);
+}
+
+
+Block prefixSum(AnyArray const & numbers) {
+    std::vector<int64_t> integers;
+    std::vector<double> decimals;
+    bool isInteger = prefixSumsOf(
+        internal::Reduction::cellOf(numbers), integers, decimals
+    );
+
+    RenEngineHandle engine = internal::Reduction::engineOf(numbers);
+    return isInteger ? blockOf(integers, engine) : blockOf(decimals, engine);
+}
+
+
+std::vector<int64_t> histogram(
+    AnyArray const & numbers,
+    double low,
+    double high,
+    size_t buckets
+){
+    return histogramOf(
+        internal::Reduction::cellOf(numbers), low, high, buckets
+    );
+}
+
+
+
+//
+// NATIVES
+//
+
+//
+// The work that may throw runs under internal::failOnThrow(), including
+// making result blocks (ArrayBuilder turns running out of memory into a C++
+// exception).
+//
+
+namespace {
+
+double numberArg(REBVAL const * arg) {
+    return IS_INTEGER(arg)
+        ? static_cast<double>(VAL_INT64(arg))
+        : VAL_DECIMAL(arg);
+}
+
+} // end anonymous namespace
+
+
+REB_R internal::Sum_Of_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+
+    Number total {true, 0, 0};
+    internal::failOnThrow("C++ exception in SUM-OF", [&]() {
+        total = sumOf(ARG(numbers));
+    });
+
+    initNumber(D_OUT, total);
+    return R_OUT;
+}
+
+
+namespace {
+
+REB_R extremeNative(
+    struct Reb_Frame *frame_,
+    REBVAL const * numbers,
+    bool max
+){
+    Number low {true, 0, 0};
+    Number high {true, 0, 0};
+    bool found = false;
+    internal::failOnThrow("C++ exception in MIN-OF or MAX-OF", [&]() {
+        found = extremesOf(numbers, low, high);
+    });
+
+    if (!found)
+        Init_Blank(D_OUT);
+    else
+        initNumber(D_OUT, max ? high : low);
+    return R_OUT;
+}
+
+} // end anonymous namespace
+
+
+REB_R internal::Min_Of_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+
+    return extremeNative(frame_, ARG(numbers), false);
+}
+
+
+REB_R internal::Max_Of_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+
+    return extremeNative(frame_, ARG(numbers), true);
+}
+
+
+REB_R internal::Mean_Of_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+
+    double result = 0;
+    internal::failOnThrow("C++ exception in MEAN-OF", [&]() {
+        result = meanOf(numbersOf(ARG(numbers)));
+    });
+
+    Init_Decimal(D_OUT, result);
+    return R_OUT;
+}
+
+
+REB_R internal::Variance_Of_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+    REFINE(2, sample);
+
+    double result = 0;
+    internal::failOnThrow("C++ exception in VARIANCE-OF", [&]() {
+        result = varianceOf(ARG(numbers), REF(sample) ? true : false);
+    });
+
+    Init_Decimal(D_OUT, result);
+    return R_OUT;
+}
+
+
+REB_R internal::Dot_Product_Native(struct Reb_Frame *frame_) {
+    PARAM(1, left);
+    PARAM(2, right);
+
+    Number total {true, 0, 0};
+    internal::failOnThrow("C++ exception in DOT-PRODUCT", [&]() {
+        total = dotOf(ARG(left), ARG(right));
+    });
+
+    initNumber(D_OUT, total);
+    return R_OUT;
+}
+
+
+REB_R internal::Prefix_Sum_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+
+    internal::failOnThrow("C++ exception in PREFIX-SUM", [&]() {
+        std::vector<int64_t> integers;
+        std::vector<double> decimals;
+        bool isInteger = prefixSumsOf(ARG(numbers), integers, decimals);
+
+        RenEngineHandle engine = Engine::runFinder().getHandle();
+        Block result = isInteger
+            ? blockOf(integers, engine)
+            : blockOf(decimals, engine);
+        Move_Value(D_OUT, internal::Reduction::cellOf(result));
+    });
+
+    return R_OUT;
+}
+
+
+REB_R internal::Histogram_Native(struct Reb_Frame *frame_) {
+    PARAM(1, numbers);
+    PARAM(2, low);
+    PARAM(3, high);
+    PARAM(4, buckets);
+
+    if (VAL_INT64(ARG(buckets)) < 1 || VAL_INT64(ARG(buckets)) > UINT32_MAX)
+        internal::failWithMessage("Histogram bucket count out of range");
+
+    size_t buckets = static_cast<size_t>(VAL_INT64(ARG(buckets)));
+
+    internal::failOnThrow("C++ exception in HISTOGRAM", [&]() {
+        std::vector<int64_t> counts = histogramOf(
+            ARG(numbers), numberArg(ARG(low)), numberArg(ARG(high)), buckets
+        );
+
+        Block result = blockOf(counts, Engine::runFinder().getHandle());
+        Move_Value(D_OUT, internal::Reduction::cellOf(result));
+    });
+
+    return R_OUT;
+}
+
+} // end namespace ren
@@ -0,0 +1,979 @@
+//
+// ring.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include "rencpp/ring.hpp"
+
+#include "common.hpp"
+
+#ifndef TO_WINDOWS
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+
+namespace ren {
+
+//
+// WIRE TAGS
+//
+// These are independent of the Reb_Kind numbering, so that the encoding does
+// not change meaning if the runtime reorders its datatypes.
+//
+
+namespace {
+
+enum class Tag : unsigned char {
+    Void, // only legal as the value of an object field
+    Blank,
+    False,
+    True,
+    Integer,
+    Decimal,
+    Char,
+
+    String,
+    TagString,
+    File,
+    Url,
+    Binary,
+
+    Word,
+    SetWord,
+    GetWord,
+    LitWord,
+    Refinement,
+    Issue,
+
+    Block,
+    Group,
+    Path,
+    SetPath,
+    GetPath,
+    LitPath,
+
+    Object,
+
+    Max
+};
+
+static_assert(
+    static_cast<unsigned char>(Tag::Max) <= 255, "Tag must fit in a byte"
+);
+
+
+struct KindMapping {
+    Tag tag;
+    enum Reb_Kind kind;
+};
+
+KindMapping const kindMappings[] = {
+    {Tag::String, REB_STRING},
+    {Tag::TagString, REB_TAG},
+    {Tag::File, REB_FILE},
+    {Tag::Url, REB_URL},
+
+    {Tag::Word, REB_WORD},
+    {Tag::SetWord, REB_SET_WORD},
+    {Tag::GetWord, REB_GET_WORD},
+    {Tag::LitWord, REB_LIT_WORD},
+    {Tag::Refinement, REB_REFINEMENT},
+    {Tag::Issue, REB_ISSUE},
+
+    {Tag::Block, REB_BLOCK},
+    {Tag::Group, REB_GROUP},
+    {Tag::Path, REB_PATH},
+    {Tag::SetPath, REB_SET_PATH},
+    {Tag::GetPath, REB_GET_PATH},
+    {Tag::LitPath, REB_LIT_PATH}
+};
+
+
+bool tagForKind(enum Reb_Kind kind, Tag & tagOut) {
+    for (auto const & mapping : kindMappings) {
+        if (mapping.kind == kind) {
+            tagOut = mapping.tag;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool kindForTag(Tag tag, enum Reb_Kind & kindOut) {
+    for (auto const & mapping : kindMappings) {
+        if (mapping.tag == tag) {
+            kindOut = mapping.kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
+//
+// ENCODER
+//
+
+template <class T>
+void putRaw(std::vector<unsigned char> & out, T const & value) {
+    auto bytes = reinterpret_cast<unsigned char const *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+
+void putTag(std::vector<unsigned char> & out, Tag tag) {
+    out.push_back(static_cast<unsigned char>(tag));
+}
+
+
+void putBytes(
+    std::vector<unsigned char> & out,
+    void const * data,
+    size_t size
+) {
+    if (size > UINT32_MAX)
+        throw std::runtime_error("Series too large for binary encoding");
+
+    putRaw(out, static_cast<uint32_t>(size));
+    auto bytes = reinterpret_cast<unsigned char const *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+
+void putSpelling(std::vector<unsigned char> & out, REBSTR * spelling) {
+    putBytes(out, STR_HEAD(spelling), STR_SIZE(spelling));
+}
+
+
+// Strings in the runtime are either Latin-1 bytes or REBUNI codepoints, and
+// are written as UTF-8 (see internal::appendUtf8).
+//
+void putStringAsUtf8(std::vector<unsigned char> & out, RELVAL const * v) {
+    REBSER * series = VAL_SERIES(v);
+    REBCNT index = VAL_INDEX(v);
+    REBCNT len = VAL_LEN_AT(v);
+
+    size_t lengthAt = out.size();
+    putRaw(out, static_cast<uint32_t>(0)); // patched below
+
+    internal::appendUtf8(out, series, index, len);
+
+    size_t size = out.size() - lengthAt - sizeof(uint32_t);
+    if (size > UINT32_MAX)
+        throw std::runtime_error("String too large for binary encoding");
+
+    uint32_t size32 = static_cast<uint32_t>(size);
+    memcpy(&out[lengthAt], &size32, sizeof(size32));
+}
+
+
+// The arrays and objects being encoded, from the outermost in.  A block that
+// contains itself (or an object that refers to itself) has no encoding, and
+// would otherwise recurse until the stack overflowed.  So would a tree that's
+// just very deep, so there's a limit on that too, which the decoder checks
+// as well.
+//
+using Visiting = std::vector<REBSER *>;
+
+size_t const maxNesting = 256;
+
+void enterSeries(Visiting & visiting, REBSER * series) {
+    if (std::find(visiting.begin(), visiting.end(), series) != visiting.end())
+        throw bad_value_cast("Cyclic value has no binary encoding");
+    if (visiting.size() == maxNesting)
+        throw bad_value_cast("Value nested too deeply for binary encoding");
+    visiting.push_back(series);
+}
+
+
+void encodeCell(
+    std::vector<unsigned char> & out,
+    RELVAL const * v,
+    Visiting & visiting
+) {
+    if (IS_VOID(v)) {
+        putTag(out, Tag::Void);
+        return;
+    }
+
+    enum Reb_Kind kind = VAL_TYPE(v);
+    Tag tag;
+
+    switch (kind) {
+    case REB_BLANK:
+        putTag(out, Tag::Blank);
+        return;
+
+    case REB_LOGIC:
+        putTag(out, VAL_LOGIC(v) ? Tag::True : Tag::False);
+        return;
+
+    case REB_INTEGER:
+        putTag(out, Tag::Integer);
+        putRaw(out, static_cast<int64_t>(VAL_INT64(v)));
+        return;
+
+    case REB_DECIMAL:
+        putTag(out, Tag::Decimal);
+        putRaw(out, static_cast<double>(VAL_DECIMAL(v)));
+        return;
+
+    case REB_CHAR:
+        putTag(out, Tag::Char);
+        putRaw(out, static_cast<uint32_t>(VAL_CHAR(v)));
+        return;
+
+    case REB_BINARY:
+        putTag(out, Tag::Binary);
+        putBytes(out, VAL_BIN_AT(v), VAL_LEN_AT(v));
+        return;
+
+    case REB_OBJECT: {
+        putTag(out, Tag::Object);
+
+        // Spellings of the visible keys first, then their values, so that
+        // the decoder can make the context before filling it in.
+        //
+        REBCTX * context = VAL_CONTEXT(v);
+        enterSeries(visiting, SER(CTX_VARLIST(context)));
+
+        uint32_t count = 0;
+        REBVAL * key = CTX_KEYS_HEAD(context);
+        for (; NOT_END(key); ++key)
+            if (!GET_VAL_FLAG(key, TYPESET_FLAG_HIDDEN))
+                ++count;
+        putRaw(out, count);
+
+        key = CTX_KEYS_HEAD(context);
+        for (; NOT_END(key); ++key)
+            if (!GET_VAL_FLAG(key, TYPESET_FLAG_HIDDEN))
+                putSpelling(out, VAL_KEY_SPELLING(key));
+
+        key = CTX_KEYS_HEAD(context);
+        REBVAL * var = CTX_VARS_HEAD(context);
+        for (; NOT_END(key); ++key, ++var)
+            if (!GET_VAL_FLAG(key, TYPESET_FLAG_HIDDEN))
+                encodeCell(out, var, visiting);
+
+        visiting.pop_back();
+        return; }
+
+    default:
+        if (!tagForKind(kind, tag))
+            throw bad_value_cast(
+                "Value type has no binary encoding (only blanks, logics,"
+                " numbers, chars, strings, words, arrays, and objects)"
+            );
+        break;
+    }
+
+    putTag(out, tag);
+
+    if (ANY_WORD(v)) {
+        putSpelling(out, VAL_WORD_SPELLING(v));
+    }
+    else if (ANY_STRING(v)) {
+        putStringAsUtf8(out, v);
+    }
+    else {
+        assert(ANY_ARRAY(v));
+
+        REBCNT len = VAL_LEN_AT(v);
+        putRaw(out, static_cast<uint32_t>(len));
+
+        enterSeries(visiting, SER(VAL_ARRAY(v)));
+
+        RELVAL const * item = ARR_AT(VAL_ARRAY(v), VAL_INDEX(v));
+        for (; NOT_END(item); ++item)
+            encodeCell(out, item, visiting);
+
+        visiting.pop_back();
+    }
+}
+
+
+
+//
+// DECODER
+//
+// None of this code may throw or construct anything with a destructor, as it
+// runs under a trap and an allocation failure would longjmp across it.  It
+// writes directly into the cells of arrays that are already reachable from
+// the output, so a recycle in the middle would see a consistent tree.
+//
+
+struct Reader {
+    unsigned char const * at;
+    unsigned char const * end;
+
+    bool take(void * out, size_t size) {
+        if (static_cast<size_t>(end - at) < size)
+            return false;
+        memcpy(out, at, size);
+        at += size;
+        return true;
+    }
+
+    bool takeSized(unsigned char const * & data, uint32_t & size) {
+        if (!take(&size, sizeof(size)))
+            return false;
+        if (static_cast<size_t>(end - at) < size)
+            return false;
+        data = at;
+        at += size;
+        return true;
+    }
+};
+
+
+// `depth` is how many arrays and objects the cell is inside of
+//
+bool decodeCell(
+    Reader & reader,
+    RELVAL * out,
+    bool allowVoid,
+    size_t depth
+){
+    unsigned char tagByte;
+    if (!reader.take(&tagByte, 1))
+        return false;
+    if (tagByte >= static_cast<unsigned char>(Tag::Max))
+        return false;
+
+    Tag tag = static_cast<Tag>(tagByte);
+
+    switch (tag) {
+    case Tag::Void:
+        if (!allowVoid)
+            return false;
+        Init_Void(out);
+        return true;
+
+    case Tag::Blank:
+        Init_Blank(out);
+        return true;
+
+    case Tag::False:
+    case Tag::True:
+        Init_Logic(out, tag == Tag::True ? TRUE : FALSE);
+        return true;
+
+    case Tag::Integer: {
+        int64_t i;
+        if (!reader.take(&i, sizeof(i)))
+            return false;
+        Init_Integer(out, i);
+        return true; }
+
+    case Tag::Decimal: {
+        double d;
+        if (!reader.take(&d, sizeof(d)))
+            return false;
+        Init_Decimal(out, d);
+        return true; }
+
+    case Tag::Char: {
+        uint32_t c;
+        if (!reader.take(&c, sizeof(c)))
+            return false;
+        Init_Char(out, static_cast<REBUNI>(c));
+        return true; }
+
+    case Tag::Binary: {
+        unsigned char const * data;
+        uint32_t size;
+        if (!reader.takeSized(data, size))
+            return false;
+        REBSER * series = Make_Binary(size);
+        memcpy(BIN_HEAD(series), data, size);
+        TERM_BIN_LEN(series, size);
+        Init_Binary(out, series);
+        return true; }
+
+    case Tag::Object: {
+        if (depth == maxNesting)
+            return false;
+
+        uint32_t count;
+        if (!reader.take(&count, sizeof(count)))
+            return false;
+
+        // Every key takes at least its size, and every value a byte, which
+        // bounds a bogus count before it turns into a giant allocation.
+        //
+        size_t remaining = static_cast<size_t>(reader.end - reader.at);
+        if (count > remaining / (sizeof(uint32_t) + 1))
+            return false;
+
+        // Collect the keys as SET-WORD!s, which is the form that context
+        // creation knows how to scan for.
+        //
+        REBARR * keys = Make_Array(count);
+        for (uint32_t n = 0; n < count; ++n) {
+            unsigned char const * data;
+            uint32_t size;
+            if (!reader.takeSized(data, size)) {
+                Free_Array(keys);
+                return false;
+            }
+            Init_Any_Word(
+                Alloc_Tail_Array(keys),
+                REB_SET_WORD,
+                Intern_UTF8_Managed(data, size)
+            );
+        }
+
+        REBCTX * context = Make_Selfish_Context_Detect(
+            REB_OBJECT, // type
+            ARR_HEAD(keys), // scan for set-words in
+            nullptr // parent
+        );
+        Init_Object(out, context);
+
+        for (uint32_t n = 0; n < count; ++n) {
+            REBCNT index = Find_Canon_In_Context(
+                context, VAL_WORD_CANON(ARR_AT(keys, n)), FALSE
+            );
+            if (
+                index == 0
+                || !decodeCell(
+                    reader, CTX_VAR(context, index), true, depth + 1
+                )
+            ){
+                Free_Array(keys);
+                return false;
+            }
+        }
+
+        Free_Array(keys);
+        return true; }
+
+    case Tag::Max:
+        return false;
+
+    default:
+        break;
+    }
+
+    enum Reb_Kind kind;
+    if (!kindForTag(tag, kind))
+        return false;
+
+    if (tag >= Tag::Word && tag <= Tag::Issue) {
+        unsigned char const * data;
+        uint32_t size;
+        if (!reader.takeSized(data, size))
+            return false;
+        Init_Any_Word(out, kind, Intern_UTF8_Managed(data, size));
+        return true;
+    }
+
+    if (tag >= Tag::String && tag <= Tag::Url) {
+        unsigned char const * data;
+        uint32_t size;
+        if (!reader.takeSized(data, size))
+            return false;
+        Init_Any_Series(
+            out, kind, Make_Sized_String_UTF8(cs_cast(data), size)
+        );
+        return true;
+    }
+
+    if (depth == maxNesting)
+        return false;
+
+    uint32_t count;
+    if (!reader.take(&count, sizeof(count)))
+        return false;
+
+    // Every item takes at least a byte, which bounds a bogus count before
+    // it turns into a giant allocation.
+    //
+    if (count > static_cast<size_t>(reader.end - reader.at))
+        return false;
+
+    REBARR * array = Make_Array(count);
+    Init_Any_Array(out, kind, array);
+
+    for (uint32_t n = 0; n < count; ++n) {
+        RELVAL * item = Alloc_Tail_Array(array);
+        Init_Blank(item);
+        if (!decodeCell(reader, item, false, depth + 1))
+            return false;
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+
+namespace internal {
+
+void BinaryCodec::encode(
+    AnyValue const & value,
+    std::vector<unsigned char> & out
+) {
+    Visiting visiting;
+    encodeCell(out, value.cell, visiting);
+}
+
+
+bool BinaryCodec::decode(
+    unsigned char const * data,
+    size_t size,
+    AnyValue & out
+) noexcept {
+    Reader reader;
+    reader.at = data;
+    reader.end = data + size;
+
+    bool ok = false;
+
+    try {
+        internal::trapped("Error decoding ring entry", [&]() {
+            ok = decodeCell(reader, out.cell, false, 0)
+                && reader.at == reader.end;
+        });
+    }
+    catch (std::runtime_error const &) {
+        // `ok` stays false, and the half-built value is blanked below
+    }
+
+    if (!ok)
+        Init_Blank(out.cell); // don't leave a half-built array visible
+    return ok;
+}
+
+} // end namespace internal
+
+
+
+//
+// SHARED MEMORY RING BUFFER
+//
+
+//
+// The counters are free-running byte positions; `head - tail` is how much is
+// in use, and a position is turned into an offset by masking with the power
+// of two capacity.  They sit on separate cache lines so that the producer
+// and consumer aren't fighting over one.
+//
+
+struct SharedRing::Header {
+    uint64_t magic;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> head; // written only by producer
+    alignas(64) std::atomic<uint64_t> tail; // written only by consumer
+};
+
+static uint64_t const ringMagic = 0x52454E52494E4731ULL; // "RENRING1"
+
+
+#ifndef TO_WINDOWS
+
+static std::string shmName(std::string const & name) {
+    if (name.empty() || name[0] != '/')
+        return "/" + name;
+    return name;
+}
+
+
+SharedRing::SharedRing (int descriptor, bool owner, std::string const & name) :
+    descriptor (descriptor),
+    owner (owner),
+    name (name),
+    header (nullptr),
+    ring (nullptr),
+    mappedSize (0)
+{
+}
+
+
+SharedRing::SharedRing (SharedRing && other) noexcept :
+    descriptor (other.descriptor),
+    owner (other.owner),
+    name (std::move(other.name)),
+    header (other.header),
+    ring (other.ring),
+    mappedSize (other.mappedSize),
+    scratch (std::move(other.scratch))
+{
+    other.descriptor = -1;
+    other.owner = false;
+    other.header = nullptr;
+    other.ring = nullptr;
+    other.mappedSize = 0;
+}
+
+
+SharedRing::~SharedRing () {
+    if (header)
+        ::munmap(header, mappedSize);
+    if (descriptor != -1)
+        ::close(descriptor);
+    if (owner && !name.empty())
+        ::shm_unlink(name.c_str());
+}
+
+
+void SharedRing::map(bool initialize, size_t capacity) {
+    if (initialize) {
+        size_t rounded = 64;
+        while (rounded < capacity)
+            rounded <<= 1;
+
+        mappedSize = sizeof(Header) + rounded;
+        if (::ftruncate(descriptor, static_cast<off_t>(mappedSize)) != 0)
+            throw std::runtime_error("SharedRing couldn't size shared memory");
+    }
+    else {
+        struct stat info;
+        if (::fstat(descriptor, &info) != 0)
+            throw std::runtime_error("SharedRing couldn't stat shared memory");
+        mappedSize = static_cast<size_t>(info.st_size);
+        if (mappedSize <= sizeof(Header))
+            throw std::runtime_error("SharedRing memory is not a ring");
+    }
+
+    void * memory = ::mmap(
+        nullptr,
+        mappedSize,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED,
+        descriptor,
+        0
+    );
+    if (memory == MAP_FAILED)
+        throw std::runtime_error("SharedRing couldn't map shared memory");
+
+    ring = reinterpret_cast<unsigned char *>(memory) + sizeof(Header);
+
+    if (initialize) {
+        header = new (memory) Header;
+        header->magic = ringMagic;
+        header->capacity = mappedSize - sizeof(Header);
+        header->head.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+    }
+    else {
+        header = reinterpret_cast<Header *>(memory);
+        if (
+            header->magic != ringMagic
+            || header->capacity != mappedSize - sizeof(Header)
+        ){
+            throw std::runtime_error("SharedRing memory is not a ring");
+        }
+    }
+
+    // Lock-free atomics are address-free, which is what makes them usable
+    // between processes.  Anything else would be a mutex in *our* memory.
+    //
+    if (!header->head.is_lock_free())
+        throw std::runtime_error("SharedRing needs lock-free 64-bit atomics");
+}
+
+
+SharedRing SharedRing::create(std::string const & name, size_t capacity) {
+    std::string posixName = shmName(name);
+    int fd = ::shm_open(posixName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1)
+        throw std::runtime_error("SharedRing couldn't create " + posixName);
+
+    SharedRing result {fd, true, posixName};
+    result.map(true, capacity);
+    return result;
+}
+
+
+SharedRing SharedRing::attach(std::string const & name) {
+    std::string posixName = shmName(name);
+    int fd = ::shm_open(posixName.c_str(), O_RDWR, 0600);
+    if (fd == -1)
+        throw std::runtime_error("SharedRing couldn't open " + posixName);
+
+    SharedRing result {fd, false, std::string {}};
+    result.map(false, 0);
+    return result;
+}
+
+
+SharedRing SharedRing::anonymous(size_t capacity) {
+    int fd = -1;
+
+#ifdef SYS_memfd_create
+    fd = static_cast<int>(::syscall(SYS_memfd_create, "rencpp-ring", 0));
+#endif
+
+    if (fd == -1) {
+        // No memfd; make a uniquely named object and drop the name at once,
+        // so only the descriptor keeps it alive.
+        //
+        std::string posixName
+            = "/rencpp-ring-" + std::to_string(static_cast<long>(::getpid()));
+        fd = ::shm_open(posixName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd != -1)
+            ::shm_unlink(posixName.c_str());
+    }
+
+    if (fd == -1)
+        throw std::runtime_error("SharedRing couldn't create shared memory");
+
+    SharedRing result {fd, false, std::string {}};
+    result.map(true, capacity);
+    return result;
+}
+
+
+SharedRing SharedRing::fromFd(int fd) {
+    int ownFd = ::dup(fd);
+    if (ownFd == -1)
+        throw std::runtime_error("SharedRing couldn't duplicate descriptor");
+
+    SharedRing result {ownFd, false, std::string {}};
+    result.map(false, 0);
+    return result;
+}
+
+
+size_t SharedRing::capacity() const {
+    return static_cast<size_t>(header->capacity);
+}
+
+
+bool SharedRing::isEmpty() const {
+    return header->head.load(std::memory_order_acquire)
+        == header->tail.load(std::memory_order_acquire);
+}
+
+
+void SharedRing::writeBytes(
+    uint64_t position,
+    void const * data,
+    size_t size
+) {
+    auto bytes = reinterpret_cast<unsigned char const *>(data);
+    size_t offset = static_cast<size_t>(position & (header->capacity - 1));
+    size_t first = std::min(size, capacity() - offset);
+    memcpy(ring + offset, bytes, first);
+    memcpy(ring, bytes + first, size - first);
+}
+
+
+void SharedRing::readBytes(uint64_t position, void * data, size_t size) const {
+    auto bytes = reinterpret_cast<unsigned char *>(data);
+    size_t offset = static_cast<size_t>(position & (header->capacity - 1));
+    size_t first = std::min(size, capacity() - offset);
+    memcpy(bytes, ring + offset, first);
+    memcpy(bytes + first, ring, size - first);
+}
+
+
+
+//
+// PRODUCER
+//
+
+size_t SharedRing::push(AnyValue const values[], size_t numValues) {
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t tail = header->tail.load(std::memory_order_acquire);
+    size_t available = capacity() - static_cast<size_t>(head - tail);
+
+    // Encode the records back to back into the scratch buffer, stopping at
+    // the first one that would overflow, then copy and publish them in one
+    // go.
+    //
+    scratch.clear();
+    size_t pushed = 0;
+
+    for (; pushed < numValues; ++pushed) {
+        size_t recordStart = scratch.size();
+        putRaw(scratch, static_cast<uint32_t>(0));
+        internal::BinaryCodec::encode(values[pushed], scratch);
+
+        size_t size = scratch.size() - recordStart - sizeof(uint32_t);
+        if (size + sizeof(uint32_t) > capacity() || size > UINT32_MAX) {
+            scratch.resize(recordStart);
+            if (pushed != 0)
+                break; // publish the ones before it, throw on the next push
+            throw std::length_error(
+                "SharedRing record is larger than the ring's capacity"
+            );
+        }
+        if (scratch.size() > available) {
+            scratch.resize(recordStart);
+            break;
+        }
+
+        uint32_t size32 = static_cast<uint32_t>(size);
+        memcpy(&scratch[recordStart], &size32, sizeof(size32));
+    }
+
+    if (pushed == 0)
+        return 0;
+
+    writeBytes(head, scratch.data(), scratch.size());
+    header->head.store(head + scratch.size(), std::memory_order_release);
+    return pushed;
+}
+
+
+bool SharedRing::push(AnyValue const & value) {
+    return push(&value, 1) == 1;
+}
+
+
+
+//
+// CONSUMER
+//
+
+size_t SharedRing::pop(std::vector<AnyValue> & out, size_t maxValues) {
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    uint64_t head = header->head.load(std::memory_order_acquire);
+
+    size_t popped = 0;
+    bool malformed = false;
+
+    while (popped < maxValues && tail != head) {
+        uint32_t size;
+        readBytes(tail, &size, sizeof(size));
+        tail += sizeof(size);
+
+        if (size > head - tail) { // producer is broken, don't trust it
+            tail = head;
+            malformed = true;
+            break;
+        }
+
+        // A record which doesn't wrap can be decoded in place; otherwise it
+        // is stitched together in the scratch buffer first.
+        //
+        size_t offset = static_cast<size_t>(tail & (header->capacity - 1));
+        unsigned char const * data;
+        if (offset + size <= capacity())
+            data = ring + offset;
+        else {
+            scratch.resize(size);
+            readBytes(tail, scratch.data(), size);
+            data = scratch.data();
+        }
+
+        AnyValue value;
+        if (internal::BinaryCodec::decode(data, size, value))
+            out.push_back(std::move(value));
+        else
+            malformed = true;
+
+        tail += size;
+        ++popped;
+
+        if (malformed)
+            break;
+    }
+
+    // Release the space only after decoding, since records were read in place.
+    //
+    header->tail.store(tail, std::memory_order_release);
+
+    if (malformed)
+        throw std::runtime_error("SharedRing record could not be decoded");
+
+    return popped;
+}
+
+
+optional<AnyValue> SharedRing::pop() {
+    std::vector<AnyValue> result;
+    if (pop(result, 1) == 0)
+        return nullopt;
+    return result[0];
+}
+
+
+#else // TO_WINDOWS
+
+//
+// !!! A CreateFileMapping version would be straightforward, but nothing in
+// the Windows build needs it yet.
+//
+
+SharedRing::SharedRing (int descriptor, bool owner, std::string const & name) :
+    descriptor (descriptor),
+    owner (owner),
+    name (name),
+    header (nullptr),
+    ring (nullptr),
+    mappedSize (0)
+{
+    throw std::runtime_error("SharedRing is not supported on Windows");
+}
+
+SharedRing::SharedRing (SharedRing && other) noexcept :
+    descriptor (other.descriptor),
+    owner (other.owner),
+    header (nullptr),
+    ring (nullptr),
+    mappedSize (0)
+{
+}
+
+SharedRing::~SharedRing () {}
+
+SharedRing SharedRing::create(std::string const & name, size_t) {
+    return SharedRing {-1, false, name};
+}
+
+SharedRing SharedRing::attach(std::string const & name) {
+    return SharedRing {-1, false, name};
+}
+
+SharedRing SharedRing::anonymous(size_t) {
+    return SharedRing {-1, false, std::string {}};
+}
+
+SharedRing SharedRing::fromFd(int) {
+    return SharedRing {-1, false, std::string {}};
+}
+
+size_t SharedRing::capacity() const { return 0; }
+
+bool SharedRing::isEmpty() const { return true; }
+
+bool SharedRing::push(AnyValue const &) { return false; }
+
+size_t SharedRing::push(AnyValue const [], size_t) { return 0; }
+
+optional<AnyValue> SharedRing::pop() { return nullopt; }
+
+size_t SharedRing::pop(std::vector<AnyValue> &, size_t) { return 0; }
+
+#endif
+
+} // end namespace ren
@@ -16,6 +16,8 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
@@ -27,6 +29,7 @@
 #include "rencpp/engine.hpp"
 #include "rencpp/rebol.hpp"
 #include "rencpp/arrays.hpp"
+#include "rencpp/error.hpp"
 
 #include "common.hpp"
 
@@ -148,22 +151,48 @@ namespace ren {
 
 RebolRuntime runtime {true};
 
-static void loadAndBindWord(
-    REBVAL *out,
-    REBCTX * context,
-    unsigned char const * nameUtf8,
-    size_t lenBytes,
-    enum Reb_Kind kind
+
+//
+// Make a native FUNCTION! and put it in the lib context, the way the
+// runtime's own natives are found.  This is done during initialization, so
+// it can't use ren::Function::construct (which needs a running engine).
+//
+void internal::addLibNative(
+    char const * name,
+    char const * spec,
+    REBNAT dispatcher
 ) {
-    Init_Any_Word(out, kind, Intern_UTF8_Managed(nameUtf8, lenBytes));
+    // Names that the runtime itself didn't define have to be added to lib.
+    // The user context picks them up when code that uses them is bound.
+    //
+    DECLARE_LOCAL (word);
+    Init_Word(word, Intern_UTF8_Managed(cb_cast(name), strlen(name)));
+    if (Try_Bind_Word(Lib_Context, word) == 0)
+        Append_Context(Lib_Context, word, NULL);
 
-    // The word is now well formed, but unbound.  If you supplied a
-    // context we will bind it here.
+    const char *rebol_runtime_utf8 = "rebol-runtime.cpp";
+    REBSTR *rebol_runtime_filename = Intern_UTF8_Managed(
+        cb_cast(rebol_runtime_utf8), strlen(rebol_runtime_utf8)
+    );
 
-    if (context) {
-        REBCNT index = Try_Bind_Word(context, out);
-        assert(index != 0);
-    }
+    DECLARE_LOCAL (specBlock);
+    Init_Block(
+        specBlock,
+        Scan_UTF8_Managed(
+            rebol_runtime_filename, cb_cast(spec), strlen(spec)
+        )
+    );
+
+    REBFUN *native = Make_Function(
+        Make_Paramlist_Managed_May_Fail(specBlock, MKF_KEYWORDS),
+        dispatcher,
+        NULL, // no underlying function, this is foundational
+        NULL // no exemplar, this isn't a specialization
+    );
+    Move_Value(
+        Sink_Var_May_Fail(word, SPECIFIED),
+        FUNC_VALUE(native)
+    );
 }
 
 
@@ -242,15 +271,7 @@ bool RebolRuntime::lazyInitializeIfNecessary() {
     // is kept here to keep the technique in order if it becomes necessary
     // for some other patch.)
 
-    REBYTE test_name[] = "test-rencpp-low-level-hook";
-
-    DECLARE_LOCAL (testWord);
-    loadAndBindWord(
-        testWord,
-        Lib_Context, test_name, LEN_BYTES(test_name), REB_WORD
-    );
-
-    const REBYTE testSpecStr[] = {
+    const char testSpecStr[] = {
         "{Ren-C++ demo of a test extension function.}"
         " value {Some value}"
         " /refine {Some refinement}"
@@ -270,28 +291,119 @@ bool RebolRuntime::lazyInitializeIfNecessary() {
         return R_OUT;
     };
 
-    const char *rebol_runtime_utf8 = "rebol-runtime.cpp";
-    REBSTR *rebol_runtime_filename = Intern_UTF8_Managed(
-        cb_cast(rebol_runtime_utf8), strlen(rebol_runtime_utf8)
+    internal::addLibNative(
+        "test-rencpp-low-level-hook", testSpecStr, testDispatcher
     );
 
-    DECLARE_LOCAL (testSpec);
-    Init_Block(
-        testSpec,
-        Scan_UTF8_Managed(
-            rebol_runtime_filename, testSpecStr, LEN_BYTES(testSpecStr)
-        )
+    // Natives that Ren-C++ itself provides, which are implemented in the
+    // files for the C++ features they expose.
+
+    internal::addLibNative(
+        "parallel-map",
+        "{Map a C++ kernel over an array's elements on a thread pool}"
+        " series [any-array!] {Elements must all suit the kernel's input}"
+        " kernel [word!] {Name given to ren::registerParallelKernel}",
+        &internal::Parallel_Map_Native
     );
 
-    REBFUN *testNative = Make_Function(
-        Make_Paramlist_Managed_May_Fail(testSpec, MKF_KEYWORDS),
-        testDispatcher,
-        NULL, // no underlying function, this is foundational
-        NULL // no exemplar, this isn't a specialization
+    internal::addLibNative(
+        "find-text",
+        "{Search string memory directly, giving the match position or blank}"
+        " string [any-string!]"
+        " pattern [any-string! char!] {Case-sensitive, as with FIND/CASE}",
+        &internal::Find_Text_Native
     );
-    Move_Value(
-        Sink_Var_May_Fail(testWord, SPECIFIED),
-        FUNC_VALUE(testNative)
+
+    internal::addLibNative(
+        "find-any-char",
+        "{Position of the first of a set of characters, or blank}"
+        " string [any-string!]"
+        " chars [any-string!] {The characters to look for}",
+        &internal::Find_Any_Char_Native
+    );
+
+    internal::addLibNative(
+        "count-char",
+        "{Number of times a character appears in a string}"
+        " string [any-string!]"
+        " character [char!]",
+        &internal::Count_Char_Native
+    );
+
+    internal::addLibNative(
+        "count-lines",
+        "{Number of lines, counting a last line with no newline at its end}"
+        " string [any-string!]",
+        &internal::Count_Lines_Native
+    );
+
+    internal::addLibNative(
+        "split-text",
+        "{Block of the pieces of a string between each delimiter}"
+        " string [any-string!]"
+        " delimiter [char!]",
+        &internal::Split_Text_Native
+    );
+
+    internal::addLibNative(
+        "sum-of",
+        "{Total of an array's numbers, an integer if they're all integers}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}",
+        &internal::Sum_Of_Native
+    );
+
+    internal::addLibNative(
+        "min-of",
+        "{Smallest of an array's numbers, or blank if there are none}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}",
+        &internal::Min_Of_Native
+    );
+
+    internal::addLibNative(
+        "max-of",
+        "{Largest of an array's numbers, or blank if there are none}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}",
+        &internal::Max_Of_Native
+    );
+
+    internal::addLibNative(
+        "mean-of",
+        "{Arithmetic mean of an array's numbers}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}",
+        &internal::Mean_Of_Native
+    );
+
+    internal::addLibNative(
+        "variance-of",
+        "{Population variance of an array's numbers}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}"
+        " /sample {Sample variance (divides by one less than the count)}",
+        &internal::Variance_Of_Native
+    );
+
+    internal::addLibNative(
+        "dot-product",
+        "{Sum of the products of two arrays' numbers, pairwise}"
+        " left [any-array!]"
+        " right [any-array!] {Must be the same length as left}",
+        &internal::Dot_Product_Native
+    );
+
+    internal::addLibNative(
+        "prefix-sum",
+        "{Block of the running totals of an array's numbers}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}",
+        &internal::Prefix_Sum_Native
+    );
+
+    internal::addLibNative(
+        "histogram",
+        "{Block of counts of numbers in equal divisions of a range}"
+        " numbers [any-array!] {INTEGER! and DECIMAL! elements}"
+        " low [integer! decimal!]"
+        " high [integer! decimal!] {Included, in the last bucket}"
+        " buckets [integer!]",
+        &internal::Histogram_Native
     );
 
     return true;
@@ -311,6 +423,8 @@ void RebolRuntime::cancel() {
 
 RebolRuntime::~RebolRuntime () {
     if (initialized) {
+        internal::forgetSymbols();
+
         OS_QUIT_DEVICES(0);
 
         Shutdown_Core();
@@ -325,9 +439,10 @@ optional<AnyValue> Runtime::evaluate(
 ) {
     AnyValue result (AnyValue::Dont::Initialize);
 
-    AnyContext context = contextPtr
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
         ? *contextPtr
-        : AnyContext::current(engine);
+        : AnyContext::resolve(engine, found);
 
     if (AnyValue::constructOrApplyInitialize(
         context.getEngine(),
@@ -344,4 +459,226 @@ optional<AnyValue> Runtime::evaluate(
     return nullopt;
 }
 
+
+
+//
+// BATCH EVALUATION
+//
+// The loaded code and the results share one managed array (rooted by a
+// value on the C++ side), two cells per snippet: the code is replaced by its
+// result or error, and the second cell is where the evaluation writes and
+// where a throw leaves its name.  Only when a snippet fails is the trap set
+// up again, for the rest of the batch.
+//
+
+namespace {
+
+enum class BatchStatus : unsigned char {
+    Pending,
+    Value,
+    Void,
+    LoadError,
+    EvaluationError,
+    Thrown,
+    ThrownVoid
+};
+
+} // end anonymous namespace
+
+
+std::vector<BatchResult> Runtime::evaluateBatch(
+    std::vector<std::string> const & sources,
+    AnyContext const * contextPtr,
+    Engine * engine
+) {
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
+        ? *contextPtr
+        : AnyContext::resolve(engine, found);
+
+    RenEngineHandle handle = context.getEngine();
+
+    size_t count = sources.size();
+    if (count > UINT32_MAX / 2)
+        throw std::runtime_error("Too many snippets for evaluateBatch");
+
+    std::vector<BatchStatus> status (count, BatchStatus::Pending);
+    AnyValue holder; // roots the slots once they're made
+
+    // longjmp could "clobber" these if they were not volatile, and the code
+    // in the `if (error)` branch depends on their values
+
+    REBARR * volatile slots = nullptr;
+    volatile size_t next = 0;
+    volatile bool evaluating = false;
+
+    REBCTX * error;
+    struct Reb_State state;
+
+    while (true) {
+        PUSH_UNHALTABLE_TRAP(&error, &state);
+
+    // The first time through the following code 'error' will be NULL, but...
+    // `fail` can longjmp here, so 'error' won't be NULL *if* that happens!
+
+        if (error != NULL) {
+            if (ERR_NUM(error) == RE_HALT)
+                throw evaluation_halt {};
+
+            if (slots == nullptr || next >= count)
+                throw std::runtime_error("Couldn't set up evaluateBatch");
+
+            Init_Error(ARR_AT(slots, 2 * next), error);
+            Init_Blank(ARR_AT(slots, 2 * next + 1));
+            status[next] = evaluating
+                ? BatchStatus::EvaluationError
+                : BatchStatus::LoadError;
+            next = next + 1;
+            continue;
+        }
+
+        if (slots == nullptr) {
+            REBCNT len = static_cast<REBCNT>(2 * count);
+            REBARR * made = Make_Array(len);
+            for (REBCNT n = 0; n < len; ++n)
+                Init_Blank(ARR_AT(made, n));
+            TERM_ARRAY_LEN(made, len);
+            MANAGE_ARRAY(made);
+            Init_Block(holder.cell, made);
+            slots = made;
+        }
+
+        if (!evaluating) {
+            const char *batch_utf8 = "evaluateBatch";
+            REBSTR *batch_filename = Intern_UTF8_Managed(
+                cb_cast(batch_utf8), strlen(batch_utf8)
+            );
+
+            for (; next < count; ++next) {
+                std::string const & source = sources[next];
+                REBARR * loaded = Scan_UTF8_Managed(
+                    batch_filename,
+                    cb_cast(source.data()),
+                    static_cast<REBCNT>(source.size())
+                );
+                Init_Block(ARR_AT(slots, 2 * next), loaded);
+            }
+
+            // Bind all the snippets, then resolve whatever words that added
+            // to the context against lib, once for the whole batch.
+
+            REBCTX * c = VAL_CONTEXT(context.cell);
+            REBCNT len = CTX_LEN(c);
+
+            for (size_t n = 0; n < count; ++n) {
+                if (status[n] != BatchStatus::Pending)
+                    continue;
+                Bind_Values_All_Deep(
+                    ARR_HEAD(VAL_ARRAY(ARR_AT(slots, 2 * n))), c
+                );
+            }
+
+            DECLARE_LOCAL (vali);
+            Init_Integer(vali, len);
+
+            Resolve_Context(
+                c,
+                Lib_Context,
+                vali,
+                FALSE, // !all
+                FALSE // !expand
+            );
+
+            evaluating = true;
+            next = 0;
+        }
+
+        for (; next < count; ++next) {
+            if (status[next] != BatchStatus::Pending)
+                continue;
+
+            RELVAL * code = ARR_AT(slots, 2 * next);
+            RELVAL * out = ARR_AT(slots, 2 * next + 1);
+
+            if (Generalized_Apply_Throws(
+                KNOWN(out),
+                nullptr, // no applicand
+                VAL_ARRAY(code),
+                SPECIFIED
+            )) {
+                CATCH_THROWN(KNOWN(code), KNOWN(out));
+                if (IS_VOID(code)) {
+                    Init_Blank(code); // arrays can't hold voids
+                    status[next] = BatchStatus::ThrownVoid;
+                }
+                else
+                    status[next] = BatchStatus::Thrown;
+            }
+            else if (IS_VOID(out)) {
+                Init_Blank(out);
+                status[next] = BatchStatus::Void;
+            }
+            else {
+                Move_Value(code, KNOWN(out));
+                Init_Blank(out);
+                status[next] = BatchStatus::Value;
+            }
+        }
+
+        DROP_TRAP_SAME_STACKLEVEL_AS_PUSH(&state);
+        break;
+    }
+
+    std::vector<BatchResult> results;
+    results.reserve(count);
+
+    for (size_t n = 0; n < count; ++n) {
+        REBVAL * first = KNOWN(ARR_AT(slots, 2 * n));
+        REBVAL * second = KNOWN(ARR_AT(slots, 2 * n + 1));
+
+        switch (status[n]) {
+        case BatchStatus::Value:
+            results.emplace_back(
+                AnyValue::fromCell_<AnyValue>(first, handle)
+            );
+            break;
+
+        case BatchStatus::Void:
+            results.emplace_back(optional<AnyValue> {});
+            break;
+
+        case BatchStatus::LoadError:
+            results.emplace_back(std::make_exception_ptr(
+                load_error {AnyValue::fromCell_<Error>(first, handle)}
+            ));
+            break;
+
+        case BatchStatus::EvaluationError:
+            results.emplace_back(std::make_exception_ptr(
+                evaluation_error {AnyValue::fromCell_<Error>(first, handle)}
+            ));
+            break;
+
+        case BatchStatus::Thrown:
+        case BatchStatus::ThrownVoid: {
+            optional<AnyValue> value;
+            if (status[n] == BatchStatus::Thrown)
+                value = AnyValue::fromCell_<AnyValue>(first, handle);
+            results.emplace_back(std::make_exception_ptr(
+                evaluation_throw {
+                    value,
+                    AnyValue::fromCell_<optional<AnyValue>>(second, handle)
+                }
+            ));
+            break; }
+
+        case BatchStatus::Pending:
+        default:
+            throw std::runtime_error("evaluateBatch left a snippet unfinished");
+        }
+    }
+
+    return results;
+}
+
 } // end namespace ren
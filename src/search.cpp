@@ -0,0 +1,622 @@
+//
+// search.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define REN_SEARCH_SSE2 1
+#else
+    #define REN_SEARCH_SSE2 0
+#endif
+
+#include "rencpp/value.hpp"
+#include "rencpp/strings.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// SEARCH KERNELS
+//
+
+//
+// These scan a string's series memory in place.  A series holds one byte per
+// character if they all fit in Latin-1, else one wide unit each, so every
+// kernel is a template on the unit type.  The vector paths compare sixteen
+// bytes at a time with SSE2 (always present on x86-64); there is a plain
+// loop for the leftover tail and for other processors.
+//
+// Substring search checks the first and last unit of the needle across a
+// whole vector at once, and only compares the middle at positions where
+// both matched, which is rare in real text.
+//
+// Positions are counted in characters from the string's index.
+//
+
+namespace {
+
+struct Text {
+    unsigned char const * data;
+    size_t wide;
+    size_t len;
+
+    Text at(size_t offset) const {
+        return Text {data + offset * wide, wide, len - offset};
+    }
+};
+
+
+Text textOf(RELVAL const * cell) {
+    REBSER * series = VAL_SERIES(cell);
+    size_t wide = SER_WIDE(series);
+    return Text {
+        SER_DATA_RAW(series) + VAL_INDEX(cell) * wide,
+        wide,
+        VAL_LEN_AT(cell)
+    };
+}
+
+
+inline unsigned lowestBit(unsigned mask) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned n = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+
+inline unsigned bitCount(unsigned mask) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#else
+    unsigned n = 0;
+    for (; mask != 0; mask &= mask - 1)
+        ++n;
+    return n;
+#endif
+}
+
+
+#if REN_SEARCH_SSE2
+
+inline __m128i splat(uint8_t c) {
+    return _mm_set1_epi8(static_cast<char>(c));
+}
+
+inline __m128i splat(uint16_t c) {
+    return _mm_set1_epi16(static_cast<short>(c));
+}
+
+inline __m128i splat(uint32_t c) {
+    return _mm_set1_epi32(static_cast<int>(c));
+}
+
+inline __m128i equal(__m128i a, __m128i b, uint8_t) {
+    return _mm_cmpeq_epi8(a, b);
+}
+
+inline __m128i equal(__m128i a, __m128i b, uint16_t) {
+    return _mm_cmpeq_epi16(a, b);
+}
+
+inline __m128i equal(__m128i a, __m128i b, uint32_t) {
+    return _mm_cmpeq_epi32(a, b);
+}
+
+template <class T>
+inline __m128i load(T const * p) {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+}
+
+// One bit per byte, so sizeof(T) bits per unit
+//
+inline unsigned maskOf(__m128i v) {
+    return static_cast<unsigned>(_mm_movemask_epi8(v));
+}
+
+#endif
+
+
+// False if the codepoint can't appear in a series of this width
+//
+template <class T>
+bool toUnit(char32_t c, T & unit) {
+    if (c > static_cast<char32_t>(static_cast<T>(-1)))
+        return false;
+    unit = static_cast<T>(c);
+    return true;
+}
+
+
+template <class T>
+size_t findUnit(T const * p, size_t n, T c) {
+    size_t i = 0;
+
+#if REN_SEARCH_SSE2
+    const size_t lanes = 16 / sizeof(T);
+    __m128i target = splat(c);
+    for (; n - i >= lanes; i += lanes) {
+        unsigned mask = maskOf(equal(load(p + i), target, T {}));
+        if (mask != 0)
+            return i + lowestBit(mask) / sizeof(T);
+    }
+#endif
+
+    for (; i < n; ++i) {
+        if (p[i] == c)
+            return i;
+    }
+    return AnyString::npos;
+}
+
+
+template <class T>
+size_t countUnit(T const * p, size_t n, T c) {
+    size_t total = 0;
+    size_t i = 0;
+
+#if REN_SEARCH_SSE2
+    const size_t lanes = 16 / sizeof(T);
+    __m128i target = splat(c);
+    for (; n - i >= lanes; i += lanes)
+        total += bitCount(maskOf(equal(load(p + i), target, T {})))
+            / sizeof(T);
+#endif
+
+    for (; i < n; ++i) {
+        if (p[i] == c)
+            ++total;
+    }
+    return total;
+}
+
+
+template <class T>
+size_t findUnits(T const * p, size_t n, T const * needle, size_t m) {
+    if (m == 0)
+        return 0;
+    if (m > n)
+        return AnyString::npos;
+    if (m == 1)
+        return findUnit(p, n, needle[0]);
+
+    size_t last = n - m; // last position a match could start
+    size_t middle = (m - 2) * sizeof(T);
+    size_t i = 0;
+
+#if REN_SEARCH_SSE2
+    const size_t lanes = 16 / sizeof(T);
+    const unsigned unitMask = (1u << sizeof(T)) - 1;
+    __m128i first = splat(needle[0]);
+    __m128i final = splat(needle[m - 1]);
+
+    for (; last + 1 - i >= lanes; i += lanes) {
+        unsigned mask = maskOf(_mm_and_si128(
+            equal(load(p + i), first, T {}),
+            equal(load(p + i + m - 1), final, T {})
+        ));
+        while (mask != 0) {
+            size_t k = lowestBit(mask) / sizeof(T);
+            if (memcmp(p + i + k + 1, needle + 1, middle) == 0)
+                return i + k;
+            mask &= ~(unitMask << (k * sizeof(T)));
+        }
+    }
+#endif
+
+    for (; i <= last; ++i) {
+        if (
+            p[i] == needle[0]
+            && p[i + m - 1] == needle[m - 1]
+            && memcmp(p + i + 1, needle + 1, middle) == 0
+        ){
+            return i;
+        }
+    }
+    return AnyString::npos;
+}
+
+
+template <class T>
+size_t findAnyUnit(T const * p, size_t n, std::vector<T> const & set) {
+    if (set.empty())
+        return AnyString::npos;
+
+    size_t i = 0;
+
+#if REN_SEARCH_SSE2
+    // Small sets (the usual delimiters and whitespace) are compared against
+    // every unit of a vector at once.
+    //
+    if (set.size() <= 8) {
+        const size_t lanes = 16 / sizeof(T);
+        __m128i targets[8];
+        for (size_t j = 0; j < set.size(); ++j)
+            targets[j] = splat(set[j]);
+
+        for (; n - i >= lanes; i += lanes) {
+            __m128i chunk = load(p + i);
+            __m128i hits = _mm_setzero_si128();
+            for (size_t j = 0; j < set.size(); ++j)
+                hits = _mm_or_si128(hits, equal(chunk, targets[j], T {}));
+
+            unsigned mask = maskOf(hits);
+            if (mask != 0)
+                return i + lowestBit(mask) / sizeof(T);
+        }
+    }
+#endif
+
+    bool low[256] = {};
+    std::vector<T> high;
+    for (T c : set) {
+        if (c < 256)
+            low[c] = true;
+        else
+            high.push_back(c);
+    }
+    std::sort(high.begin(), high.end());
+
+    for (; i < n; ++i) {
+        T c = p[i];
+        if (c < 256 ? low[c] : std::binary_search(high.begin(), high.end(), c))
+            return i;
+    }
+    return AnyString::npos;
+}
+
+
+//
+// Width dispatch.  Each operation is a struct with a static run<T>, as C++11
+// has no generic lambdas.
+//
+
+template <class Op, class... Args>
+size_t dispatch(Text const & text, Args const &... args) {
+    switch (text.wide) {
+    case 1:
+        return Op::template run<uint8_t>(text, args...);
+    case 2:
+        return Op::template run<uint16_t>(text, args...);
+    case 4:
+        return Op::template run<uint32_t>(text, args...);
+    default:
+        throw std::runtime_error("Unsupported string series width");
+    }
+}
+
+
+template <class T>
+T const * unitsOf(Text const & text) {
+    return reinterpret_cast<T const *>(text.data);
+}
+
+
+struct FindChar {
+    template <class T>
+    static size_t run(Text const & text, char32_t c) {
+        T unit;
+        if (!toUnit(c, unit))
+            return AnyString::npos;
+        return findUnit(unitsOf<T>(text), text.len, unit);
+    }
+};
+
+struct CountChar {
+    template <class T>
+    static size_t run(Text const & text, char32_t c) {
+        T unit;
+        if (!toUnit(c, unit))
+            return 0;
+        return countUnit(unitsOf<T>(text), text.len, unit);
+    }
+};
+
+struct FindText {
+    template <class T>
+    static size_t run(Text const & text, std::u32string const & needle) {
+        std::vector<T> units (needle.size());
+        for (size_t n = 0; n < needle.size(); ++n) {
+            if (!toUnit(needle[n], units[n]))
+                return AnyString::npos;
+        }
+        return findUnits(
+            unitsOf<T>(text), text.len, units.data(), units.size()
+        );
+    }
+};
+
+struct FindAnyOf {
+    template <class T>
+    static size_t run(Text const & text, std::u32string const & chars) {
+        std::vector<T> units;
+        for (char32_t c : chars) {
+            T unit;
+            if (toUnit(c, unit))
+                units.push_back(unit);
+        }
+        return findAnyUnit(unitsOf<T>(text), text.len, units);
+    }
+};
+
+
+size_t countLines(Text const & text) {
+    if (text.len == 0)
+        return 0;
+
+    // A last line without a newline at the end still counts
+
+    size_t newlines = dispatch<CountChar>(text, U'\n');
+    bool endsWithNewline =
+        dispatch<FindChar>(text.at(text.len - 1), U'\n') == 0;
+    return endsWithNewline ? newlines : newlines + 1;
+}
+
+
+// Codepoints of a string's text, or of UTF-8 from C++
+//
+std::u32string codepointsOf(RELVAL const * cell) {
+    std::u32string result;
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT index = VAL_INDEX(cell);
+    REBCNT len = VAL_LEN_AT(cell);
+    result.reserve(len);
+    for (REBCNT n = index; n < index + len; ++n)
+        result.push_back(GET_ANY_CHAR(series, n));
+    return result;
+}
+
+
+std::u32string codepointsOf(char const * utf8, size_t size) {
+    auto bytes = reinterpret_cast<unsigned char const *>(utf8);
+    std::u32string result;
+    size_t i = 0;
+    while (i < size) {
+        char32_t c;
+        size_t length = internal::decodeUtf8(c, bytes + i, size - i);
+        if (length == 0)
+            throw std::runtime_error("Invalid UTF-8 passed to string search");
+        result.push_back(c);
+        i += length;
+    }
+    return result;
+}
+
+} // end anonymous namespace
+
+
+
+//
+// C++ INTERFACE
+//
+
+size_t AnyString::find(char const * needle) const {
+    return dispatch<FindText>(
+        textOf(cell), codepointsOf(needle, strlen(needle))
+    );
+}
+
+
+size_t AnyString::find(std::string const & needle) const {
+    return dispatch<FindText>(
+        textOf(cell), codepointsOf(needle.data(), needle.size())
+    );
+}
+
+
+size_t AnyString::find(char32_t c) const {
+    return dispatch<FindChar>(textOf(cell), c);
+}
+
+
+size_t AnyString::findAnyOf(char const * chars) const {
+    return dispatch<FindAnyOf>(
+        textOf(cell), codepointsOf(chars, strlen(chars))
+    );
+}
+
+
+size_t AnyString::count(char32_t c) const {
+    return dispatch<CountChar>(textOf(cell), c);
+}
+
+
+size_t AnyString::countLines() const {
+    return ren::countLines(textOf(cell));
+}
+
+
+std::vector<std::string> AnyString::split(char32_t delimiter) const {
+    Text text = textOf(cell);
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT index = VAL_INDEX(cell);
+
+    std::vector<std::string> pieces;
+    size_t start = 0;
+    while (true) {
+        size_t found = dispatch<FindChar>(text.at(start), delimiter);
+        size_t len = found == npos ? text.len - start : found;
+
+        pieces.emplace_back();
+        internal::appendUtf8(
+            pieces.back(),
+            series,
+            index + static_cast<REBCNT>(start),
+            static_cast<REBCNT>(len)
+        );
+
+        if (found == npos)
+            return pieces;
+        start += found + 1;
+    }
+}
+
+
+
+//
+// NATIVES
+//
+
+//
+// The same kernels for Ren code, for when FIND and PARSE TO over multi-
+// megabyte strings are the bottleneck.  Positions come back as the string
+// at that position, or BLANK! if not found, the way FIND does.  Matching is
+// case-sensitive, so FIND-TEXT is the equivalent of FIND/CASE (plain FIND
+// ignores case).  Anything that may throw runs under internal::failOnThrow().
+//
+
+namespace {
+
+REB_R returnPosition(
+    struct Reb_Frame *frame_,
+    REBVAL const * string,
+    size_t pos
+){
+    if (pos == AnyString::npos) {
+        Init_Blank(D_OUT);
+        return R_OUT;
+    }
+    Move_Value(D_OUT, string);
+    D_OUT->payload.any_series.index += static_cast<REBCNT>(pos);
+    return R_OUT;
+}
+
+} // end anonymous namespace
+
+
+REB_R internal::Find_Text_Native(struct Reb_Frame *frame_) {
+    PARAM(1, string);
+    PARAM(2, pattern);
+
+    size_t pos = AnyString::npos;
+
+    internal::failOnThrow("C++ exception in FIND-TEXT", [&]() {
+        Text text = textOf(ARG(string));
+        if (IS_CHAR(ARG(pattern)))
+            pos = dispatch<FindChar>(
+                text, static_cast<char32_t>(VAL_CHAR(ARG(pattern)))
+            );
+        else
+            pos = dispatch<FindText>(text, codepointsOf(ARG(pattern)));
+    });
+
+    return returnPosition(frame_, ARG(string), pos);
+}
+
+
+REB_R internal::Find_Any_Char_Native(struct Reb_Frame *frame_) {
+    PARAM(1, string);
+    PARAM(2, chars);
+
+    size_t pos = AnyString::npos;
+
+    internal::failOnThrow("C++ exception in FIND-ANY-CHAR", [&]() {
+        pos = dispatch<FindAnyOf>(
+            textOf(ARG(string)), codepointsOf(ARG(chars))
+        );
+    });
+
+    return returnPosition(frame_, ARG(string), pos);
+}
+
+
+REB_R internal::Count_Char_Native(struct Reb_Frame *frame_) {
+    PARAM(1, string);
+    PARAM(2, character);
+
+    Text text = textOf(ARG(string));
+    char32_t c = static_cast<char32_t>(VAL_CHAR(ARG(character)));
+
+    if (text.wide != 1 && text.wide != 2 && text.wide != 4)
+        internal::failWithMessage("Unsupported string series width");
+
+    Init_Integer(D_OUT, static_cast<REBI64>(dispatch<CountChar>(text, c)));
+    return R_OUT;
+}
+
+
+REB_R internal::Count_Lines_Native(struct Reb_Frame *frame_) {
+    PARAM(1, string);
+
+    Text text = textOf(ARG(string));
+
+    if (text.wide != 1 && text.wide != 2 && text.wide != 4)
+        internal::failWithMessage("Unsupported string series width");
+
+    Init_Integer(D_OUT, static_cast<REBI64>(countLines(text)));
+    return R_OUT;
+}
+
+
+REB_R internal::Split_Text_Native(struct Reb_Frame *frame_) {
+    PARAM(1, string);
+    PARAM(2, delimiter);
+
+    Text text = textOf(ARG(string));
+    char32_t delimiter = static_cast<char32_t>(VAL_CHAR(ARG(delimiter)));
+
+    if (text.wide != 1 && text.wide != 2 && text.wide != 4)
+        internal::failWithMessage("Unsupported string series width");
+
+    REBSER * series = VAL_SERIES(ARG(string));
+    REBCNT index = VAL_INDEX(ARG(string));
+    enum Reb_Kind kind = VAL_TYPE(ARG(string));
+
+    REBARR * pieces = Make_Array(
+        static_cast<REBCNT>(dispatch<CountChar>(text, delimiter) + 1)
+    );
+
+    size_t start = 0;
+    while (true) {
+        size_t found = dispatch<FindChar>(text.at(start), delimiter);
+        size_t len = found == AnyString::npos ? text.len - start : found;
+
+        Init_Any_Series(
+            Alloc_Tail_Array(pieces),
+            kind,
+            Copy_Sequence_At_Len(
+                series,
+                index + static_cast<REBCNT>(start),
+                static_cast<REBCNT>(len)
+            )
+        );
+
+        if (found == AnyString::npos)
+            break;
+        start += found + 1;
+    }
+
+    Init_Block(D_OUT, pieces);
+    return R_OUT;
+}
+
+} // end namespace ren
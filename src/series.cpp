@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 
@@ -11,6 +12,9 @@
 
 namespace ren {
 
+constexpr size_t AnySeries::npos;
+
+
 //
 // TYPE DETECTION
 //
@@ -26,6 +30,36 @@ bool AnySeries::isValid(REBVAL const * cell) {
 // ITERATION
 //
 
+namespace {
+
+// Element `index` (from the head) of a series, which must be in range.
+// Arrays copy the cell, strings give a CHAR!, binaries an INTEGER!, and
+// vectors an INTEGER! or DECIMAL!.
+//
+void initElement(REBVAL * out, REBVAL const * series, REBCNT index) {
+    if (ANY_STRING(series)) {
+        // from str_to_char in Rebol source
+        Init_Char(out, GET_ANY_CHAR(VAL_SERIES(series), index));
+    }
+    else if (ANY_ARRAY(series)) {
+        Derelativize(
+            out, ARR_AT(VAL_ARRAY(series), index), VAL_SPECIFIER(series)
+        );
+    }
+    else if (IS_BINARY(series)) {
+        Init_Integer(out, *BIN_AT(VAL_SERIES(series), index));
+    }
+    else if (IS_VECTOR(series)) {
+        internal::initVectorElement(out, series, index);
+    }
+    else {
+        // Images and such are not wrapped yet
+        UNREACHABLE_CODE();
+    }
+}
+
+} // end anonymous namespace
+
 
 void ren::internal::AnySeries_::operator++() {
     cell->payload.any_series.index++;
@@ -50,24 +84,11 @@ void ren::internal::AnySeries_::operator--(int) {
 AnyValue ren::internal::AnySeries_::operator*() const {
     AnyValue result {Dont::Initialize};
 
-    if (0 == VAL_LEN_AT(cell)) {
+    if (0 == VAL_LEN_AT(cell))
         Init_Void(result.cell);
-    }
-    else if (ANY_STRING(cell)) {
-        // from str_to_char in Rebol source
-        Init_Char(
-            cell,
-            GET_ANY_CHAR(VAL_SERIES(cell), VAL_INDEX(cell))
-        );
-    } else if (GET_SER_FLAG(VAL_SERIES(cell), SERIES_FLAG_ARRAY)) {
-        Derelativize(
-            result.cell,
-            ARR_AT(VAL_ARRAY(cell), VAL_INDEX(cell)), VAL_SPECIFIER(cell)
-        );
-    } else {
-        // Binary and such, would return an integer
-        UNREACHABLE_CODE();
-    }
+    else
+        initElement(result.cell, cell, VAL_INDEX(cell));
+
     result.finishInit(origin);
     return result;
 }
@@ -88,6 +109,25 @@ void ren::internal::AnySeries_::tail() {
 }
 
 
+AnySeries::iterator AnySeries::begin() const {
+    return iterator {cell, VAL_INDEX(cell), origin};
+}
+
+
+AnySeries::iterator AnySeries::end() const {
+    // see remarks on tail modifying vs. returning a value
+    return iterator {cell, VAL_LEN_HEAD(cell), origin};
+}
+
+
+AnyValue AnySeries::iterator::operator*() const {
+    AnyValue result {Dont::Initialize};
+    initElement(result.cell, series, static_cast<REBCNT>(index));
+    result.finishInit(origin);
+    return result;
+}
+
+
 size_t AnySeries::length() const {
     return VAL_LEN_AT(cell);
 }
@@ -114,4 +154,64 @@ AnyValue AnySeries::operator[](AnyValue const & picker) const {
 }
 
 
+AnyValue AnySeries::operator[](int index) const {
+    if (index < 1 || static_cast<REBCNT>(index) > VAL_LEN_AT(cell))
+        return (*this)[AnyValue {index}];
+
+    AnyValue result {Dont::Initialize};
+    initElement(
+        result.cell, cell, VAL_INDEX(cell) + static_cast<REBCNT>(index) - 1
+    );
+    result.finishInit(origin);
+    return result;
+}
+
+
+
+//
+// MODIFICATION
+//
+
+void internal::checkWritable(REBVAL const * series) {
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_SERIES(VAL_SERIES(series));
+    });
+}
+
+
+void AnySeries::remove(size_t offset, size_t count) {
+    size_t len = VAL_LEN_AT(cell);
+    if (offset > len)
+        throw std::out_of_range("AnySeries::remove() offset past the tail");
+    count = std::min(count, len - offset);
+
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_SERIES(VAL_SERIES(cell));
+        Remove_Series(
+            VAL_SERIES(cell),
+            VAL_INDEX(cell) + static_cast<REBCNT>(offset),
+            static_cast<REBINT>(count)
+        );
+    });
+}
+
+
+void AnySeries::clear() {
+    remove(0, length());
+}
+
+
+void AnySeries::reserve(size_t count) {
+    REBSER * series = VAL_SERIES(cell);
+
+    // One unit of the rest is for the terminator
+    //
+    if (SER_REST(series) - SER_LEN(series) > count)
+        return;
+
+    internal::trapped("Error reserving series (out of memory?)", [&]() {
+        Extend_Series(series, static_cast<REBCNT>(count));
+    });
+}
+
 } // end namespace ren
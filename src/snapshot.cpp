@@ -0,0 +1,600 @@
+//
+// snapshot.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rencpp/snapshot.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// STORAGE
+//
+// For text nodes `first` and `count` are an offset and size in the text
+// buffer, and for arrays and objects the index of the first child node and
+// the number of children.  Children of objects carry their field name, and
+// the sorted keys of a node are the range [keysBegin, keysBegin + keysCount)
+// of the key entries.
+//
+
+struct Snapshot::Node {
+    Kind kind;
+    uint32_t first;
+    uint32_t count;
+    uint32_t keysBegin;
+    uint32_t keysCount;
+    uint32_t nameOffset;
+    uint32_t nameSize;
+    union {
+        bool logic;
+        int64_t integer;
+        double decimal;
+        uint32_t character;
+    };
+};
+
+
+struct Snapshot::KeyEntry {
+    uint32_t textOffset;
+    uint32_t textSize;
+    uint32_t child;
+};
+
+
+struct Snapshot::Data {
+    std::vector<Node> nodes;
+    std::vector<KeyEntry> keys;
+    std::string text;
+};
+
+
+namespace {
+
+// Rebol words compare case-insensitively.  Only ASCII is folded here, which
+// covers the field names that lookups are used for in practice.
+//
+int compareKey(
+    char const * a, size_t aSize,
+    char const * b, size_t bSize
+) {
+    size_t n = std::min(aSize, bSize);
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char ca = static_cast<unsigned char>(a[i]);
+        unsigned char cb = static_cast<unsigned char>(b[i]);
+        if (ca >= 'A' && ca <= 'Z')
+            ca = static_cast<unsigned char>(ca - 'A' + 'a');
+        if (cb >= 'A' && cb <= 'Z')
+            cb = static_cast<unsigned char>(cb - 'A' + 'a');
+        if (ca != cb)
+            return ca < cb ? -1 : 1;
+    }
+    if (aSize == bSize)
+        return 0;
+    return aSize < bSize ? -1 : 1;
+}
+
+
+uint32_t checkedSize(size_t size) {
+    if (size > UINT32_MAX)
+        throw std::runtime_error("Value too large for a Snapshot");
+    return static_cast<uint32_t>(size);
+}
+
+} // end anonymous namespace
+
+
+
+//
+// BUILDER
+//
+// Nodes are always addressed by index while building, because filling in a
+// child can grow the node vector and move everything.  The children of an
+// array are reserved before any of them is filled, which is what keeps them
+// adjacent.
+//
+
+struct Snapshot::Builder {
+    Data & data;
+    std::vector<void const *> enclosing; // arrays and contexts being copied
+
+    explicit Builder (Data & data) : data (data) {}
+
+    uint32_t addText(void const * bytes, size_t size) {
+        uint32_t offset = checkedSize(data.text.size());
+        data.text.append(static_cast<char const *>(bytes), size);
+        checkedSize(data.text.size());
+        return offset;
+    }
+
+    void setText(uint32_t index, void const * bytes, size_t size) {
+        uint32_t offset = addText(bytes, size);
+        data.nodes[index].first = offset;
+        data.nodes[index].count = checkedSize(size);
+    }
+
+    void setSpelling(uint32_t index, REBSTR * spelling) {
+        setText(index, STR_HEAD(spelling), STR_SIZE(spelling));
+    }
+
+    // Strings in the runtime are either Latin-1 bytes or REBUNI codepoints,
+    // and the text is stored as UTF-8 (see internal::appendUtf8).
+    //
+    void setStringAsUtf8(uint32_t index, RELVAL const * v) {
+        REBSER * series = VAL_SERIES(v);
+        REBCNT at = VAL_INDEX(v);
+        REBCNT len = VAL_LEN_AT(v);
+
+        std::string & text = data.text;
+        uint32_t offset = checkedSize(text.size());
+
+        internal::appendUtf8(text, series, at, len);
+
+        data.nodes[index].first = offset;
+        data.nodes[index].count = checkedSize(text.size() - offset);
+    }
+
+    // MOLD can fail, so it's done under a trap with nothing on the stack
+    // that has a destructor.  (Same approach as EnginePool::moldAsUtf8.)
+    //
+    void setMolded(uint32_t index, RELVAL const * v) {
+        REBSER * utf8_series;
+
+        internal::trapped("Error during MOLD for Snapshot", [&]() {
+            DECLARE_MOLD (mo);
+            SET_MOLD_FLAG(mo, MOLD_FLAG_ALL);
+
+            Push_Mold(mo);
+            Mold_Value(mo, v);
+
+            utf8_series = Pop_Molded_UTF8(mo);
+        });
+
+        try {
+            setText(index, BIN_HEAD(utf8_series), SER_LEN(utf8_series));
+        }
+        catch (...) {
+            Free_Series(utf8_series);
+            throw;
+        }
+        Free_Series(utf8_series);
+    }
+
+    void enter(void const * identity) {
+        if (
+            std::find(enclosing.begin(), enclosing.end(), identity)
+            != enclosing.end()
+        ){
+            throw std::runtime_error("Cyclic structures can't be snapshotted");
+        }
+        enclosing.push_back(identity);
+    }
+
+    void leave() {
+        enclosing.pop_back();
+    }
+
+    // Sorts the key entries added since `keysBegin` and gives them to the
+    // node.  The sort is stable so the first of any duplicate keys is found,
+    // as SELECT would.
+    //
+    void finishKeys(uint32_t index, size_t keysBegin) {
+        std::string const & text = data.text;
+        std::stable_sort(
+            data.keys.begin() + static_cast<std::ptrdiff_t>(keysBegin),
+            data.keys.end(),
+            [&text](KeyEntry const & a, KeyEntry const & b) -> bool {
+                return compareKey(
+                    &text[a.textOffset], a.textSize,
+                    &text[b.textOffset], b.textSize
+                ) < 0;
+            }
+        );
+        data.nodes[index].keysBegin = checkedSize(keysBegin);
+        data.nodes[index].keysCount = checkedSize(
+            data.keys.size() - keysBegin
+        );
+    }
+
+    void fillArray(uint32_t index, RELVAL const * v) {
+        REBARR * array = VAL_ARRAY(v);
+        enter(array);
+
+        uint32_t len = checkedSize(VAL_LEN_AT(v));
+        uint32_t first = checkedSize(data.nodes.size());
+        data.nodes.resize(first + len);
+        checkedSize(data.nodes.size());
+
+        data.nodes[index].first = first;
+        data.nodes[index].count = len;
+
+        RELVAL const * item = ARR_AT(array, VAL_INDEX(v));
+        for (uint32_t i = 0; i < len; ++i, ++item)
+            fill(first + i, item);
+
+        // `key: value` pairs can be looked up by key
+        //
+        size_t keysBegin = data.keys.size();
+        for (uint32_t i = 0; i + 1 < len; ++i) {
+            Node const & key = data.nodes[first + i];
+            if (key.kind != Kind::SetWord)
+                continue;
+            data.keys.push_back(KeyEntry {key.first, key.count, first + i + 1});
+        }
+        finishKeys(index, keysBegin);
+
+        leave();
+    }
+
+    void fillObject(uint32_t index, RELVAL const * v) {
+        REBCTX * context = VAL_CONTEXT(v);
+        enter(context);
+
+        uint32_t count = 0;
+        REBVAL * key = CTX_KEYS_HEAD(context);
+        for (; NOT_END(key); ++key)
+            if (!GET_VAL_FLAG(key, TYPESET_FLAG_HIDDEN))
+                ++count;
+
+        uint32_t first = checkedSize(data.nodes.size());
+        data.nodes.resize(first + count);
+        checkedSize(data.nodes.size());
+
+        data.nodes[index].first = first;
+        data.nodes[index].count = count;
+
+        // Keys are gathered locally, as filling in the fields will add the
+        // keys of any objects nested inside them.
+        //
+        std::vector<KeyEntry> keys;
+        keys.reserve(count);
+
+        uint32_t child = first;
+        key = CTX_KEYS_HEAD(context);
+        REBVAL * var = CTX_VARS_HEAD(context);
+        for (; NOT_END(key); ++key, ++var) {
+            if (GET_VAL_FLAG(key, TYPESET_FLAG_HIDDEN))
+                continue;
+
+            REBSTR * spelling = VAL_KEY_SPELLING(key);
+            uint32_t size = checkedSize(STR_SIZE(spelling));
+            uint32_t offset = addText(STR_HEAD(spelling), size);
+
+            data.nodes[child].nameOffset = offset;
+            data.nodes[child].nameSize = size;
+            keys.push_back(KeyEntry {offset, size, child});
+
+            if (IS_VOID(var))
+                data.nodes[child].kind = Kind::Blank; // unset field
+            else
+                fill(child, var);
+            ++child;
+        }
+
+        size_t keysBegin = data.keys.size();
+        data.keys.insert(data.keys.end(), keys.begin(), keys.end());
+        finishKeys(index, keysBegin);
+
+        leave();
+    }
+
+    void fill(uint32_t index, RELVAL const * v) {
+        Node & node = data.nodes[index]; // only until something is appended
+        node.kind = Kind::Other;
+        node.first = 0;
+        node.count = 0;
+        node.keysBegin = 0;
+        node.keysCount = 0;
+        node.integer = 0;
+
+        enum Reb_Kind kind = VAL_TYPE(v);
+
+        switch (kind) {
+        case REB_BLANK:
+            node.kind = Kind::Blank;
+            return;
+
+        case REB_LOGIC:
+            node.kind = Kind::Logic;
+            node.logic = VAL_LOGIC(v) != FALSE;
+            return;
+
+        case REB_INTEGER:
+            node.kind = Kind::Integer;
+            node.integer = VAL_INT64(v);
+            return;
+
+        case REB_DECIMAL:
+            node.kind = Kind::Decimal;
+            node.decimal = VAL_DECIMAL(v);
+            return;
+
+        case REB_CHAR:
+            node.kind = Kind::Char;
+            node.character = VAL_CHAR(v);
+            return;
+
+        case REB_BINARY:
+            node.kind = Kind::Binary;
+            setText(index, VAL_BIN_AT(v), VAL_LEN_AT(v));
+            return;
+
+        case REB_WORD:
+            node.kind = Kind::Word;
+            setSpelling(index, VAL_WORD_SPELLING(v));
+            return;
+
+        case REB_SET_WORD:
+            node.kind = Kind::SetWord;
+            setSpelling(index, VAL_WORD_SPELLING(v));
+            return;
+
+        case REB_GET_WORD:
+            node.kind = Kind::GetWord;
+            setSpelling(index, VAL_WORD_SPELLING(v));
+            return;
+
+        case REB_LIT_WORD:
+            node.kind = Kind::LitWord;
+            setSpelling(index, VAL_WORD_SPELLING(v));
+            return;
+
+        case REB_REFINEMENT:
+            node.kind = Kind::Refinement;
+            setSpelling(index, VAL_WORD_SPELLING(v));
+            return;
+
+        case REB_ISSUE:
+            node.kind = Kind::Issue;
+            setSpelling(index, VAL_WORD_SPELLING(v));
+            return;
+
+        case REB_BLOCK:
+            node.kind = Kind::Block;
+            fillArray(index, v);
+            return;
+
+        case REB_GROUP:
+            node.kind = Kind::Group;
+            fillArray(index, v);
+            return;
+
+        case REB_PATH:
+        case REB_SET_PATH:
+        case REB_GET_PATH:
+        case REB_LIT_PATH:
+            node.kind = Kind::Path;
+            fillArray(index, v);
+            return;
+
+        case REB_OBJECT:
+            node.kind = Kind::Object;
+            fillObject(index, v);
+            return;
+
+        case REB_FUNCTION:
+            throw bad_value_cast("FUNCTION! values can't be snapshotted");
+
+        default:
+            break;
+        }
+
+        if (ANY_STRING(v)) {
+            node.kind = Kind::String;
+            setStringAsUtf8(index, v);
+            return;
+        }
+
+        setMolded(index, v); // Kind::Other
+    }
+};
+
+
+
+//
+// SNAPSHOT
+//
+
+Snapshot::Snapshot (AnyValue const & value) {
+    std::shared_ptr<Data> built = std::make_shared<Data>();
+
+    built->nodes.resize(1);
+
+    Builder builder {*built};
+    builder.fill(0, value.cell);
+
+    built->nodes.shrink_to_fit();
+    built->keys.shrink_to_fit();
+    built->text.shrink_to_fit();
+
+    data = std::move(built);
+}
+
+
+size_t Snapshot::nodeCount() const {
+    return data->nodes.size();
+}
+
+
+size_t Snapshot::textBytes() const {
+    return data->text.size();
+}
+
+
+
+//
+// VIEW
+//
+
+Snapshot::Node const & Snapshot::View::node() const {
+    return data->nodes[index];
+}
+
+
+Snapshot::Kind Snapshot::View::kind() const {
+    return node().kind;
+}
+
+
+bool Snapshot::View::isArray() const {
+    Kind k = kind();
+    return k == Kind::Block || k == Kind::Group || k == Kind::Path;
+}
+
+
+bool Snapshot::View::isWord() const {
+    Kind k = kind();
+    return k >= Kind::Word && k <= Kind::Issue;
+}
+
+
+bool Snapshot::View::hasText() const {
+    Kind k = kind();
+    return (k >= Kind::String && k <= Kind::Issue) || k == Kind::Other;
+}
+
+
+bool Snapshot::View::asLogic() const {
+    if (kind() != Kind::Logic)
+        throw bad_value_cast("Snapshot value is not a LOGIC!");
+    return node().logic;
+}
+
+
+int64_t Snapshot::View::asInteger() const {
+    if (kind() != Kind::Integer)
+        throw bad_value_cast("Snapshot value is not an INTEGER!");
+    return node().integer;
+}
+
+
+double Snapshot::View::asDecimal() const {
+    if (kind() == Kind::Integer)
+        return static_cast<double>(node().integer);
+    if (kind() != Kind::Decimal)
+        throw bad_value_cast("Snapshot value is not a DECIMAL! or INTEGER!");
+    return node().decimal;
+}
+
+
+uint32_t Snapshot::View::asChar() const {
+    if (kind() != Kind::Char)
+        throw bad_value_cast("Snapshot value is not a CHAR!");
+    return node().character;
+}
+
+
+char const * Snapshot::View::textData() const {
+    if (!hasText())
+        throw bad_value_cast("Snapshot value has no text");
+    return data->text.data() + node().first;
+}
+
+
+size_t Snapshot::View::textSize() const {
+    if (!hasText())
+        throw bad_value_cast("Snapshot value has no text");
+    return node().count;
+}
+
+
+std::string Snapshot::View::str() const {
+    return std::string {textData(), textSize()};
+}
+
+
+size_t Snapshot::View::size() const {
+    if (!isArray() && !isObject())
+        return 0;
+    return node().count;
+}
+
+
+Snapshot::const_iterator Snapshot::View::begin() const {
+    if (!isArray() && !isObject())
+        return const_iterator {data, 0};
+    return const_iterator {data, node().first};
+}
+
+
+Snapshot::const_iterator Snapshot::View::end() const {
+    if (!isArray() && !isObject())
+        return const_iterator {data, 0};
+    return const_iterator {data, node().first + node().count};
+}
+
+
+Snapshot::View Snapshot::View::operator[](size_t at) const {
+    if (at >= size())
+        throw std::out_of_range("Snapshot index out of range");
+    return View {data, node().first + static_cast<uint32_t>(at)};
+}
+
+
+std::string Snapshot::View::keyAt(size_t at) const {
+    if (!isObject())
+        throw bad_value_cast("Snapshot value is not an OBJECT!");
+    Node const & field = (*this)[at].node();
+    return std::string {data->text.data() + field.nameOffset, field.nameSize};
+}
+
+
+optional<Snapshot::View> Snapshot::View::find(std::string const & key) const {
+    Node const & n = node();
+    if (n.keysCount == 0)
+        return nullopt;
+
+    auto begin = data->keys.begin() + n.keysBegin;
+    auto end = begin + n.keysCount;
+    std::string const & text = data->text;
+
+    auto it = std::lower_bound(
+        begin, end, key,
+        [&text](KeyEntry const & entry, std::string const & k) -> bool {
+            return compareKey(
+                &text[entry.textOffset], entry.textSize, k.data(), k.size()
+            ) < 0;
+        }
+    );
+
+    if (
+        it == end
+        || compareKey(
+            &text[it->textOffset], it->textSize, key.data(), key.size()
+        ) != 0
+    ){
+        return nullopt;
+    }
+    return View {data, it->child};
+}
+
+
+Snapshot::View Snapshot::View::operator[](std::string const & key) const {
+    optional<View> found = find(key);
+    if (!found)
+        throw std::out_of_range("Snapshot has no key " + key);
+    return *found;
+}
+
+} // end namespace ren
@@ -1,3 +1,5 @@
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 #include "rencpp/value.hpp"
@@ -49,12 +51,62 @@ void AnyString::initFilename(REBVAL *cell) {
 
 
 
+//
+// UTF-8 VALIDATION
+//
+
+//
+// Text from C++ is checked before it's copied into a series, so bad input
+// is reported as an exception instead of a failure inside the interpreter.
+// Most text is ASCII, so runs of it are skipped eight bytes at a time; only
+// the bytes of multi-byte sequences are looked at individually.  Overlong
+// forms, surrogates, and codepoints past U+10FFFF are rejected.
+//
+
+bool internal::isValidUtf8(char const * data, size_t size) {
+    auto bytes = reinterpret_cast<unsigned char const *>(data);
+
+    size_t i = 0;
+    while (i < size) {
+        if (bytes[i] < 0x80) {
+            while (size - i >= 8) {
+                uint64_t word;
+                memcpy(&word, bytes + i, 8);
+                if (word & UINT64_C(0x8080808080808080))
+                    break;
+                i += 8;
+            }
+            while (i < size && bytes[i] < 0x80)
+                ++i;
+            continue;
+        }
+
+        char32_t codepoint;
+        size_t length = internal::decodeUtf8(codepoint, bytes + i, size - i);
+        if (length == 0)
+            return false;
+
+        i += length;
+    }
+
+    return true;
+}
+
+
+
 //
 // CONSTRUCTION
 //
 
+//
+// The text is copied straight into a new series; it isn't put between
+// delimiters and LOADed.  So braces, angle brackets, spaces in filenames,
+// `%` characters and embedded NULs all come through exactly as given.
+//
+
 AnyString::AnyString (
-    char const * spelling,
+    char const * data,
+    size_t size,
     internal::CellFunction cellfun,
     Engine * engine
 ) :
@@ -62,39 +114,29 @@ AnyString::AnyString (
 {
     (*cellfun)(cell);
 
+    if (!internal::isValidUtf8(data, size))
+        throw std::runtime_error("Invalid UTF-8 passed to AnyString()");
+
     if (engine == nullptr)
         engine = &Engine::runFinder();
 
-    std::string source;
+    enum Reb_Kind kind = VAL_TYPE(cell);
 
-    if (hasType<String>(*this)) {
-        source += '{';
-        source += spelling;
-        source += '}';
-    }
-    else if (hasType<Tag>(*this)) {
-        source += '<';
-        source += spelling;
-        source += '>';
-    }
-    else if (hasType<Filename>(*this)) {
-        source += "%";
-        source += spelling;
-    }
-    else
-        UNREACHABLE_CODE();
+    internal::trapped("Error making string (out of memory?)", [&]() {
+        Init_Any_Series(cell, kind, Make_Sized_String_UTF8(data, size));
+    });
+
+    finishInit(engine->getHandle());
+}
 
-    internal::Loadable loadable (source.data());
 
-    constructOrApplyInitialize(
-        engine->getHandle(),
-        nullptr, // no context
-        nullptr, // no applicand
-        &loadable,
-        1,
-        this, // Do construct
-        nullptr // Don't apply
-    );
+AnyString::AnyString (
+    char const * spelling,
+    internal::CellFunction cellfun,
+    Engine * engine
+) :
+    AnyString (spelling, strlen(spelling), cellfun, engine)
+{
 }
 
 
@@ -103,7 +145,7 @@ AnyString::AnyString (
     internal::CellFunction cellfun,
     Engine * engine
 ) :
-    AnyString (spelling.c_str(), cellfun, engine)
+    AnyString (spelling.data(), spelling.size(), cellfun, engine)
 {
 }
 
@@ -116,47 +158,87 @@ AnyString::AnyString (
     QString const & spelling,
     internal::CellFunction cellfun,
     Engine * engine
-)
-    : AnySeries(Dont::Initialize)
+) :
+    AnyString (spelling.toStdString(), cellfun, engine) // UTF-8 in Qt5
 {
-    (*cellfun)(cell);
+}
 
-    QString source;
+#endif
 
-    // Note: wouldn't be able to return char * without intermediate
-    // http://stackoverflow.com/questions/17936160/
 
-    if (hasType<String>(*this)) {
-        source += '{';
-        source += spelling;
-        source += '}';
-    }
-    else if (hasType<Tag>(*this)) {
-        source += '<';
-        source += spelling;
-        source += '>';
-    }
-    else
-        UNREACHABLE_CODE();
 
-    QByteArray utf8 = source.toUtf8();
-    internal::Loadable loadable (utf8.data());
+//
+// MODIFICATION
+//
 
-    if (engine == nullptr)
-        engine = &Engine::runFinder();
+void AnyString::insert(size_t offset, char const * utf8, size_t size) {
+    if (offset > VAL_LEN_AT(cell))
+        throw std::out_of_range("AnyString::insert() offset past the tail");
+
+    if (!internal::isValidUtf8(utf8, size))
+        throw std::runtime_error("Invalid UTF-8 passed to AnyString::insert()");
+
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT at = VAL_INDEX(cell) + static_cast<REBCNT>(offset);
+
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_SERIES(series);
 
-    constructOrApplyInitialize(
-        engine->getHandle(),
-        nullptr, // no context
-        nullptr, // no applicand
-        &loadable,
-        1,
-        this, // do construct
-        nullptr // don't apply
-    );
+        // The text is decoded into a series of the width it needs, which the
+        // insertion widens the string to match if it has to.  (The trap frees
+        // the unmanaged temporary if there's an error.)
+
+        REBSER * temp = Make_Sized_String_UTF8(utf8, size);
+        Insert_String(series, at, temp, 0, SER_LEN(temp), FALSE);
+        Free_Series(temp);
+    });
 }
 
-#endif
+
+void AnyString::insert(size_t offset, char32_t c) {
+    if (offset > VAL_LEN_AT(cell))
+        throw std::out_of_range("AnyString::insert() offset past the tail");
+
+    if (c > 0xFFFF)
+        throw std::runtime_error("Character outside the interpreter's range");
+
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT at = VAL_INDEX(cell) + static_cast<REBCNT>(offset);
+
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_SERIES(series);
+
+        if (c > 0xFF && BYTE_SIZE(series))
+            Widen_String(series, TRUE);
+        Expand_Series(series, at, 1);
+        SET_ANY_CHAR(series, at, static_cast<REBUNI>(c));
+    });
+}
+
+
+void AnyString::append(char const * utf8) {
+    insert(length(), utf8, strlen(utf8));
+}
+
+
+void AnyString::poke(size_t offset, char32_t c) {
+    if (offset >= VAL_LEN_AT(cell))
+        throw std::out_of_range("AnyString::poke() offset past the tail");
+
+    if (c > 0xFFFF)
+        throw std::runtime_error("Character outside the interpreter's range");
+
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT at = VAL_INDEX(cell) + static_cast<REBCNT>(offset);
+
+    internal::trapped("Can't modify a protected series", [&]() {
+        FAIL_IF_READ_ONLY_SERIES(series);
+
+        if (c > 0xFF && BYTE_SIZE(series))
+            Widen_String(series, TRUE);
+        SET_ANY_CHAR(series, at, static_cast<REBUNI>(c));
+    });
+}
 
 
 
@@ -164,14 +246,137 @@ AnyString::AnyString (
 // EXTRACTION
 //
 
-std::string AnyString::spellingOf_STD() const {
-    std::string result = static_cast<std::string>(*this);
-    if (hasType<String>(*this) /* or isUrl() or isEmail() or isFile() */)
-        return result;
-    if (hasType<Tag>(*this)) {
-        result.erase(0, 1);
-        return result.erase(result.length() - 1, 1);
+namespace {
+
+bool isAscii(REBYTE const * bytes, size_t size) {
+    size_t i = 0;
+    for (; size - i >= 8; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        if (word & UINT64_C(0x8080808080808080))
+            return false;
+    }
+    for (; i < size; ++i) {
+        if (bytes[i] >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+
+} // end anonymous namespace
+
+
+namespace {
+
+// The one UTF-8 encoder for series text, for both byte containers
+//
+template <class Out>
+void appendUtf8To(Out & out, REBSER * series, REBCNT index, REBCNT len) {
+    using Byte = typename Out::value_type;
+
+    for (REBCNT n = index; n < index + len; ++n) {
+        uint32_t c = GET_ANY_CHAR(series, n);
+        if (c < 0x80)
+            out.push_back(static_cast<Byte>(c));
+        else if (c < 0x800) {
+            out.push_back(static_cast<Byte>(0xC0 | (c >> 6)));
+            out.push_back(static_cast<Byte>(0x80 | (c & 0x3F)));
+        }
+        else if (c < 0x10000) {
+            out.push_back(static_cast<Byte>(0xE0 | (c >> 12)));
+            out.push_back(static_cast<Byte>(0x80 | ((c >> 6) & 0x3F)));
+            out.push_back(static_cast<Byte>(0x80 | (c & 0x3F)));
+        }
+        else {
+            out.push_back(static_cast<Byte>(0xF0 | (c >> 18)));
+            out.push_back(static_cast<Byte>(0x80 | ((c >> 12) & 0x3F)));
+            out.push_back(static_cast<Byte>(0x80 | ((c >> 6) & 0x3F)));
+            out.push_back(static_cast<Byte>(0x80 | (c & 0x3F)));
+        }
     }
+}
+
+} // end anonymous namespace
+
+
+void internal::appendUtf8(
+    std::string & out,
+    REBSER * series,
+    REBCNT index,
+    REBCNT len
+) {
+    appendUtf8To(out, series, index, len);
+}
+
+
+void internal::appendUtf8(
+    std::vector<unsigned char> & out,
+    REBSER * series,
+    REBCNT index,
+    REBCNT len
+) {
+    appendUtf8To(out, series, index, len);
+}
+
+
+AnyString::Utf8View AnyString::utf8View() const {
+    Utf8View view {*this};
+
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT len = VAL_LEN_AT(cell);
+
+    if (BYTE_SIZE(series) && isAscii(VAL_BIN_AT(cell), len)) {
+        view.direct = cs_cast(VAL_BIN_AT(cell));
+        view.length = len;
+        return view;
+    }
+
+    view.encoded.reserve(len); // at least one byte per character
+    internal::appendUtf8(view.encoded, series, VAL_INDEX(cell), len);
+    view.length = view.encoded.size();
+    return view;
+}
+
+
+AnyString::Codepoints AnyString::codepoints() const {
+    REBSER * series = VAL_SERIES(cell);
+    size_t wide = SER_WIDE(series);
+    return Codepoints {
+        *this,
+        SER_DATA_RAW(series) + VAL_INDEX(cell) * wide,
+        wide,
+        VAL_LEN_AT(cell)
+    };
+}
+
+
+AnyString::operator std::string () const {
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT len = VAL_LEN_AT(cell);
+    bool tag = IS_TAG(cell);
+
+    std::string result;
+    result.reserve(len + (tag ? 2 : 0));
+
+    if (tag)
+        result += '<';
+
+    if (BYTE_SIZE(series) && isAscii(VAL_BIN_AT(cell), len))
+        result.append(cs_cast(VAL_BIN_AT(cell)), len);
+    else
+        internal::appendUtf8(result, series, VAL_INDEX(cell), len);
+
+    if (tag)
+        result += '>';
+
+    return result;
+}
+
+
+std::string AnyString::spellingOf_STD() const {
+    if (hasType<String>(*this) || hasType<Tag>(*this))
+        return utf8View().str();
     throw std::runtime_error {"Invalid String Type"};
 }
 
@@ -179,13 +384,9 @@ std::string AnyString::spellingOf_STD() const {
 #if REN_CLASSLIB_QT
 
 QString AnyString::spellingOf_QT() const {
-    QString result = static_cast<QString>(*this);
-    if (hasType<String>(*this) /* or isUrl() or isEmail() or isFile() */)
-        return result;
-    if (hasType<Tag>(*this)) {
-        assert(result.length() >= 2);
-        return result.mid(1, result.length() - 2);
-    }
+    Utf8View text = utf8View();
+    if (hasType<String>(*this) || hasType<Tag>(*this))
+        return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
     throw std::runtime_error {"Invalid String Type"};
 }
 
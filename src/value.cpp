@@ -16,6 +16,7 @@
 // See http://rencpp.hostilefork.com for more information on this project
 //
 
+#include <cstring>
 #include <ostream>
 #include <vector>
 #include <iostream>
@@ -28,6 +29,7 @@
 #include "rencpp/runtime.hpp"
 #include "rencpp/error.hpp"
 #include "rencpp/strings.hpp"
+#include "rencpp/executor.hpp" // Unlocked::isActiveOnThisThread
 
 #include "rencpp/rebol.hpp" // ren::internal::nodes
 
@@ -55,9 +57,10 @@ optional<AnyValue> AnyValue::apply_(
 ) const {
     AnyValue result (Dont::Initialize);
 
-    AnyContext context = contextPtr
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
         ? *contextPtr
-        : AnyContext::current(engine);
+        : AnyContext::resolve(engine, found);
 
     if (constructOrApplyInitialize(
         context.getEngine(),
@@ -451,6 +454,11 @@ internal::Loadable::Loadable (QString const & source) :
 
 AnyValue::AnyValue (Dont)
 {
+    // A native that has given up the evaluator lock with ren::Unlocked may
+    // not make values until it gets the lock back.
+    //
+    assert(!Unlocked::isActiveOnThisThread());
+
     runtime.lazyInitializeIfNecessary();
 
     // We make a pairing of values, where the key stores extra tracking info.
@@ -510,6 +518,43 @@ bool AnyValue::isEqualTo(AnyValue const & other) const {
     return Compare_Modify_Values(cell_copy, other_copy, 0);
 }
 
+
+// A word's spelling is UTF-8 already, so its bytes are compared.  A string
+// holds Latin-1 bytes or wide characters, so it's compared a character at a
+// time against the decoded UTF-8, straight out of the series.
+//
+bool AnyValue::hasSpelling_(char const * utf8) const {
+    size_t size = strlen(utf8);
+
+    if (ANY_WORD(cell)) {
+        REBSTR * str = VAL_WORD_SPELLING(cell);
+        return STR_SIZE(str) == size
+            && memcmp(STR_HEAD(str), utf8, size) == 0;
+    }
+
+    assert(ANY_STRING(cell));
+
+    REBSER * series = VAL_SERIES(cell);
+    REBCNT index = VAL_INDEX(cell);
+    REBCNT len = VAL_LEN_AT(cell);
+
+    auto bytes = reinterpret_cast<unsigned char const *>(utf8);
+    size_t at = 0;
+
+    for (REBCNT n = 0; n < len; ++n) {
+        if (at == size)
+            return false;
+
+        char32_t codepoint;
+        size_t length = internal::decodeUtf8(codepoint, bytes + at, size - at);
+        if (length == 0 || codepoint != GET_ANY_CHAR(series, index + n))
+            return false;
+        at += length;
+    }
+
+    return at == size;
+}
+
 bool AnyValue::isSameAs(AnyValue const & other) const {
     // acts like REBNATIVE(sameq)
 
@@ -577,12 +622,50 @@ void AnyValue::toCell_(
 
 AnyValue AnyValue::copy(bool deep) const {
 
-    // It seems the only way to call an action is to put the arguments it
-    // expects onto the stack :-/  For instance in the dispatch of A_COPY
-    // we see it uses D_REF(ARG_COPY_DEEP) in the block handler to determine
-    // whether to copy deeply.  So there is no deep flag to Copy_Value.  :-/
-    // Exactly what the incantation would be can be figured out another
-    // day but it would look something(?) like this commented out code...
+    // Series are copied with the routines COPY uses, from their position
+    // to the tail.  (Deep copies of arrays copy the arrays inside them, and
+    // strings and binaries have nothing inside them to copy.)
+
+    if (ANY_ARRAY(cell) || ANY_STRING(cell) || IS_BINARY(cell)) {
+        AnyValue result (Dont::Initialize);
+
+        internal::trapped("Error in AnyValue::copy (out of memory?)", [&]() {
+            if (ANY_ARRAY(cell)) {
+                REBARR * copy;
+                if (deep)
+                    copy = Copy_Array_At_Deep_Managed(
+                        VAL_ARRAY(cell), VAL_INDEX(cell), VAL_SPECIFIER(cell)
+                    );
+                else {
+                    copy = Copy_Array_At_Shallow(
+                        VAL_ARRAY(cell), VAL_INDEX(cell), VAL_SPECIFIER(cell)
+                    );
+                    MANAGE_ARRAY(copy);
+                }
+                Init_Any_Array(result.cell, VAL_TYPE(cell), copy);
+            }
+            else {
+                REBSER * copy = ANY_STRING(cell)
+                    ? Copy_String_At_Len(cell, -1)
+                    : Copy_Sequence_At_Len(
+                        VAL_SERIES(cell), VAL_INDEX(cell), VAL_LEN_AT(cell)
+                    );
+                MANAGE_SERIES(copy);
+                Init_Any_Series(result.cell, VAL_TYPE(cell), copy);
+            }
+        });
+
+        result.finishInit(origin);
+        return result;
+    }
+
+    // Other types are rarer, and left to COPY itself.  It seems the only way
+    // to call an action is to put the arguments it expects onto the stack
+    // :-/  For instance in the dispatch of A_COPY we see it uses
+    // D_REF(ARG_COPY_DEEP) in the block handler to determine whether to copy
+    // deeply.  So there is no deep flag to Copy_Value.  :-/ Exactly what the
+    // incantation would be can be figured out another day but it would look
+    // something(?) like this commented out code...
 
   /*
     auto saved_DS_TOP = DS_TOP;
@@ -659,7 +742,7 @@ std::string to_string(AnyValue const & value) {
 // `fail` can longjmp here, so 'error' won't be NULL *if* that happens!
 
     if (error != NULL)
-        throw std::runtime_error("Error during to_QString (stack overflow?)");
+        throw std::runtime_error("Error during to_string (stack overflow?)");
 
     const size_t defaultBufLen = 100;
 
@@ -712,6 +795,73 @@ std::string to_string(AnyValue const & value) {
 }
 
 
+namespace {
+
+// Everything that might allocate on the C++ side is done before the trap or
+// after it's dropped.  The series popped before an error are unmanaged, and
+// are freed by the trap.
+
+template <class F>
+std::vector<std::string> formOrMold(size_t count, F && cellAt, bool mold) {
+    std::vector<REBSER *> formed (count, nullptr);
+
+    internal::trapped("Error during FORM (stack overflow?)", [&]() {
+        for (size_t n = 0; n < count; ++n) {
+            DECLARE_MOLD (mo);
+            if (mold)
+                SET_MOLD_FLAG(mo, MOLD_FLAG_ALL);
+
+            Push_Mold(mo);
+            if (mold)
+                Mold_Value(mo, cellAt(n));
+            else
+                Form_Value(mo, cellAt(n));
+
+            formed[n] = Pop_Molded_UTF8(mo);
+        }
+    });
+
+    std::vector<std::string> result;
+    size_t n = 0;
+    try {
+        result.reserve(count);
+        for (; n < count; ++n) {
+            result.emplace_back(
+                cs_cast(BIN_HEAD(formed[n])),
+                static_cast<size_t>(SER_LEN(formed[n]))
+            );
+            Free_Series(formed[n]);
+        }
+    }
+    catch (...) {
+        for (; n < count; ++n)
+            Free_Series(formed[n]);
+        throw;
+    }
+    return result;
+}
+
+} // end anonymous namespace
+
+
+std::vector<std::string> form(std::vector<AnyValue> const & values) {
+    return formOrMold(
+        values.size(),
+        [&](size_t n) -> REBVAL const * { return values[n].cell; },
+        false
+    );
+}
+
+
+std::vector<std::string> mold(std::vector<AnyValue> const & values) {
+    return formOrMold(
+        values.size(),
+        [&](size_t n) -> REBVAL const * { return values[n].cell; },
+        true
+    );
+}
+
+
 #if REN_CLASSLIB_QT == 1
 
 QString to_QString(AnyValue const & value) {
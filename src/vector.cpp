@@ -0,0 +1,170 @@
+//
+// vector.cpp
+// This file is part of RenCpp
+// Copyright (C) 2015-2018 HostileFork.com
+//
+// Licensed under the Boost License, Version 1.0 (the "License")
+//
+//      http://www.boost.org/LICENSE_1_0.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied.  See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// See http://rencpp.hostilefork.com for more information on this project
+//
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "rencpp/vector.hpp"
+#include "rencpp/engine.hpp"
+
+#include "common.hpp"
+
+
+namespace ren {
+
+//
+// TYPE DETECTION
+//
+
+bool AnyVector::isValid(REBVAL const * cell) {
+    return IS_VECTOR(cell);
+}
+
+
+namespace {
+
+// The element type is the low byte of the series' "size" (the rest is the
+// dimensions), see Make_Vector() in %t-vector.c
+//
+int encodingOfSeries(REBSER * series) {
+    return static_cast<int>(MISC(series).size & 0xFF);
+}
+
+} // end anonymous namespace
+
+
+int AnyVector::encodingOf(REBVAL const * cell) {
+    return encodingOfSeries(VAL_SERIES(cell));
+}
+
+
+
+//
+// CONSTRUCTION
+//
+
+void AnyVector::initVector(
+    int encoding,
+    void const * data,
+    size_t count,
+    Engine * engine
+) {
+    if (count > static_cast<size_t>(std::numeric_limits<REBINT>::max()))
+        throw std::invalid_argument("Too many elements for a VECTOR!");
+
+    REBINT bits = 8 << (encoding & 3);
+    REBSER * series;
+
+    internal::trapped("Error making VECTOR! (out of memory?)", [&]() {
+        series = Make_Vector(
+            (encoding >> 3) & 1, // integer or decimal
+            (encoding >> 2) & 1, // signed or unsigned
+            1, // dimensions
+            bits,
+            static_cast<REBINT>(count)
+        );
+    });
+
+    if (series == NULL)
+        throw std::runtime_error("Error making VECTOR! (out of memory?)");
+
+    if (count != 0)
+        memcpy(
+            SER_DATA_RAW(series), data, count * static_cast<size_t>(bits / 8)
+        );
+
+    Init_Any_Series(cell, REB_VECTOR, series);
+    finishInit(
+        engine ? engine->getHandle() : Engine::runFinder().getHandle()
+    );
+}
+
+
+
+//
+// ELEMENT ACCESS
+//
+
+void * AnyVector::dataAt() const {
+    REBSER * series = VAL_SERIES(cell);
+    return SER_DATA_RAW(series) + SER_WIDE(series) * VAL_INDEX(cell);
+}
+
+
+namespace {
+
+template <class T>
+T elementAt(REBSER * series, REBCNT index) {
+    T element;
+    memcpy(&element, SER_DATA_RAW(series) + sizeof(T) * index, sizeof(T));
+    return element;
+}
+
+} // end anonymous namespace
+
+
+// Unsigned 64-bit elements past the INTEGER! range wrap, as they do when the
+// interpreter picks them
+//
+void internal::initVectorElement(
+    REBVAL * out,
+    REBVAL const * vector,
+    REBCNT index
+) {
+    REBSER * s = VAL_SERIES(vector);
+
+    switch (encodingOfSeries(s)) {
+    case VectorElement<int8_t>::encoding:
+        Init_Integer(out, elementAt<int8_t>(s, index));
+        break;
+    case VectorElement<int16_t>::encoding:
+        Init_Integer(out, elementAt<int16_t>(s, index));
+        break;
+    case VectorElement<int32_t>::encoding:
+        Init_Integer(out, elementAt<int32_t>(s, index));
+        break;
+    case VectorElement<int64_t>::encoding:
+        Init_Integer(out, elementAt<int64_t>(s, index));
+        break;
+    case VectorElement<uint8_t>::encoding:
+        Init_Integer(out, elementAt<uint8_t>(s, index));
+        break;
+    case VectorElement<uint16_t>::encoding:
+        Init_Integer(out, elementAt<uint16_t>(s, index));
+        break;
+    case VectorElement<uint32_t>::encoding:
+        Init_Integer(out, elementAt<uint32_t>(s, index));
+        break;
+    case VectorElement<uint64_t>::encoding:
+        Init_Integer(
+            out, static_cast<REBI64>(elementAt<uint64_t>(s, index))
+        );
+        break;
+    case VectorElement<float>::encoding:
+        Init_Decimal(out, elementAt<float>(s, index));
+        break;
+    case VectorElement<double>::encoding:
+        Init_Decimal(out, elementAt<double>(s, index));
+        break;
+    default:
+        UNREACHABLE_CODE();
+    }
+}
+
+} // end namespace ren
@@ -1,14 +1,188 @@
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "rencpp/value.hpp"
 #include "rencpp/words.hpp"
 #include "rencpp/context.hpp"
+#include "rencpp/engine.hpp"
+#include "rencpp/rebol.hpp"
 
 #include "common.hpp"
 
 
 namespace ren {
 
+//
+// SYMBOLS
+//
+
+namespace {
+
+std::mutex symbolsMutex;
+
+// Spellings that Symbols have been made for, and a block holding a word for
+// each one so the GC doesn't collect them, until forgetSymbols().
+//
+std::unordered_set<REBSTR const *> & keptSpellings() {
+    static auto kept = new std::unordered_set<REBSTR const *>; // see below
+    return *kept;
+}
+
+AnyValue * keptWords = nullptr;
+REBARR * keptArray = nullptr;
+
+// `_sym` literals have static storage, so their address is enough to find
+// the Symbol made the first time that literal was used...unless the literal
+// was in a module that's been unloaded, and another literal is now at that
+// address.  So the text is checked against the Symbol's before it's used.
+//
+// These tables are emptied by forgetSymbols() while the runtime shuts down,
+// which happens during static destruction.  They're never destroyed, so
+// they're still there then.
+//
+std::unordered_map<char const *, Symbol> & literalSymbols() {
+    static auto symbols = new std::unordered_map<char const *, Symbol>;
+    return *symbols;
+}
+
+
+REBSTR * intern(char const * utf8, size_t size, Engine * engine) {
+    if (!internal::isValidUtf8(utf8, size))
+        throw std::runtime_error("Invalid UTF-8 passed to Symbol()");
+
+    runtime.lazyInitializeIfNecessary();
+
+    if (engine == nullptr)
+        engine = &Engine::runFinder();
+    (void)engine; // !!! one symbol table, shared by all engines
+
+    REBSTR * str;
+
+    internal::trapped("Error interning Symbol (out of memory?)", [&]() {
+        str = Intern_UTF8_Managed(cb_cast(utf8), size);
+    });
+
+    return str;
+}
+
+
+// Must be called with symbolsMutex held
+//
+void keep(REBSTR * str) {
+    if (!keptSpellings().insert(str).second)
+        return;
+
+    try {
+        internal::trapped("Error keeping Symbol (out of memory?)", [&]() {
+            Init_Word(Alloc_Tail_Array(keptArray), str);
+        });
+    }
+    catch (...) {
+        keptSpellings().erase(str);
+        throw;
+    }
+}
+
+} // end anonymous namespace
+
+
+// Doesn't root the spelling, see AnyWord::symbol()
+//
+Symbol::Symbol (void const * spelling) :
+    spelling (spelling)
+{
+    REBSTR * str = const_cast<REBSTR *>(static_cast<REBSTR const *>(spelling));
+
+    canon = STR_CANON(str);
+    head = STR_HEAD(str);
+    length = STR_SIZE(str);
+}
+
+
+Symbol::Symbol (char const * utf8, Engine * engine) :
+    Symbol (utf8, strlen(utf8), engine)
+{
+}
+
+
+Symbol::Symbol (char const * utf8, size_t size, Engine * engine) :
+    Symbol (static_cast<void const *>(intern(utf8, size, engine)))
+{
+    // Rooted for the life of the engine, unlike those borrowed from a word
+
+    REBSTR * str = const_cast<REBSTR *>(static_cast<REBSTR const *>(spelling));
+
+    std::lock_guard<std::mutex> guard (symbolsMutex);
+
+    if (keptWords == nullptr) {
+        DECLARE_LOCAL (block);
+        Init_Block(block, Make_Array(16));
+        keptWords = new AnyValue (AnyValue::fromCell_<AnyValue>(
+            block, Engine::runFinder().getHandle()
+        ));
+        keptArray = VAL_ARRAY(block);
+    }
+
+    keep(str);
+    keep(STR_CANON(str));
+}
+
+
+Symbol literals::operator"" _sym(char const * utf8, size_t size) {
+    {
+        std::lock_guard<std::mutex> guard (symbolsMutex);
+        auto it = literalSymbols().find(utf8);
+        if (
+            it != literalSymbols().end()
+            && it->second.size() == size
+            && memcmp(it->second.data(), utf8, size) == 0
+        ){
+            return it->second;
+        }
+    }
+
+    Symbol symbol {utf8, size};
+
+    std::lock_guard<std::mutex> guard (symbolsMutex);
+    auto it = literalSymbols().find(utf8);
+    if (it != literalSymbols().end())
+        it->second = symbol; // a different literal at the old one's address
+    else
+        literalSymbols().emplace(utf8, symbol);
+    return symbol;
+}
+
+
+void internal::forgetSymbols() {
+    std::lock_guard<std::mutex> guard (symbolsMutex);
+
+    literalSymbols().clear();
+    keptSpellings().clear();
+
+    delete keptWords;
+    keptWords = nullptr;
+    keptArray = nullptr;
+}
+
+
+// The word keeps its spelling alive, so this is just a handle to it.  It
+// doesn't take the symbols lock or add to the kept spellings, so it's cheap
+// to call on every word of loaded data.
+//
+Symbol AnyWord::symbol() const {
+    return Symbol {static_cast<void const *>(VAL_WORD_SPELLING(cell))};
+}
+
+
+bool AnyValue::hasWordSymbol(Symbol const & symbol) const {
+    return ANY_WORD(cell) && VAL_WORD_CANON(cell) == symbol.canon;
+}
+
+
+
 //
 // TYPE DETECTION
 //
@@ -80,37 +254,22 @@ void AnyWord::initRefinement(REBVAL *cell) {
 //
 
 std::string AnyWord::spellingOf_STD() const {
-    std::string result = to_string(*this);
-    if (hasType<Word>(*this))
-        return result;
-    if (
-        hasType<Refinement>(*this)
-        || hasType<GetWord>(*this)
-        || hasType<LitWord>(*this)
-    ){
-        return result.erase(0, 1);
-    }
-    if (hasType<SetWord>(*this))
-        return result.erase(result.length() - 1, 1);
-    throw std::runtime_error {"Invalid Word Type"};
+    REBSTR * spelling = VAL_WORD_SPELLING(cell);
+    return std::string {STR_HEAD(spelling), STR_SIZE(spelling)};
+}
+
+
+bool AnyWord::hasSpelling(char const * spelling) const {
+    return hasSpelling_(spelling);
 }
 
 
 #if REN_CLASSLIB_QT
 QString AnyWord::spellingOf_QT() const {
-    QString result = to_QString(*this);
-    if (hasType<Word>(*this))
-        return result;
-    if (
-        hasType<Refinement>(*this)
-        || hasType<GetWord>(*this)
-        || hasType<LitWord>(*this)
-    ){
-        return result.right(result.length() - 1);
-    }
-    if (hasType<SetWord>(*this))
-        return result.left(result.length() - 1);
-    throw std::runtime_error {"Invalid Word Type"};
+    REBSTR * spelling = VAL_WORD_SPELLING(cell);
+    return QString::fromUtf8(
+        STR_HEAD(spelling), static_cast<int>(STR_SIZE(spelling))
+    );
 }
 #endif
 
@@ -156,9 +315,10 @@ AnyWord::AnyWord (
 
     internal::Loadable loadable = array.data();
 
-    AnyContext context = contextPtr
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
         ? *contextPtr
-        : AnyContext::current(engine);
+        : AnyContext::resolve(engine, found);
 
     constructOrApplyInitialize(
         context.getEngine(),
@@ -212,9 +372,10 @@ AnyWord::AnyWord (
 
     internal::Loadable loadable (source);
 
-    AnyContext context = contextPtr
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
         ? *contextPtr
-        : AnyContext::current(engine);
+        : AnyContext::resolve(engine, found);
 
     constructOrApplyInitialize(
         context.getEngine(),
@@ -231,6 +392,47 @@ AnyWord::AnyWord (
 #endif
 
 
+AnyWord::AnyWord (
+    Symbol const & symbol,
+    internal::CellFunction cellfun,
+    AnyContext const * contextPtr,
+    Engine * engine
+) :
+    AnyValue (Dont::Initialize)
+{
+    (*cellfun)(cell);
+
+    enum Reb_Kind kind = VAL_TYPE(cell);
+    REBSTR * spelling = const_cast<REBSTR *>(
+        static_cast<REBSTR const *>(symbol.spelling)
+    );
+
+    optional<AnyContext> found;
+    AnyContext const & context = contextPtr
+        ? *contextPtr
+        : AnyContext::resolve(engine, found);
+
+    REBCTX * c = VAL_CONTEXT(context.cell);
+
+    internal::trapped("Error binding word made from Symbol", [&]() {
+        // Bound the way LOAD would bind it: a word not already in the context
+        // is added, and picks up the lib value for that word if there is one.
+
+        Init_Any_Word(cell, kind, spelling);
+
+        if (Try_Bind_Word(c, cell) == 0) {
+            DECLARE_LOCAL (index);
+            Init_Integer(index, CTX_LEN(c));
+
+            Append_Context(c, cell, NULL);
+            Resolve_Context(c, Lib_Context, index, FALSE, FALSE);
+        }
+    });
+
+    finishInit(context.getEngine());
+}
+
+
 AnyWord::AnyWord (AnyWord const & other, internal::CellFunction cellfun) :
     AnyValue (Dont::Initialize)
 {
@@ -0,0 +1,53 @@
+#include <string>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("batch evaluation test", "[rebol] [batch]")
+{
+    Object sandbox {};
+
+    std::vector<BatchResult> results = runtime.evaluateBatch(
+        {
+            "a: 1 + 2",
+            "a * 10", // sees `a` set by the snippet before it
+            "a: (", // load error
+            "1 / 0", // evaluation error
+            "throw 7",
+            "()", // void
+            "a + 1" // the batch carries on after failures
+        },
+        sandbox
+    );
+
+    REQUIRE(results.size() == 7);
+
+    CHECK(static_cast<Integer>(*results[0].get()) == 3);
+    CHECK(static_cast<Integer>(*results[1].get()) == 30);
+
+    CHECK(!results[2].succeeded());
+    CHECK_THROWS_AS(results[2].get(), load_error);
+
+    CHECK_THROWS_AS(results[3].get(), evaluation_error);
+
+    bool thrown = false;
+    try {
+        results[4].get();
+    }
+    catch (evaluation_throw const & t) {
+        thrown = true;
+        CHECK(static_cast<Integer>(*t.value()) == 7);
+    }
+    CHECK(thrown);
+
+    CHECK(results[5].succeeded());
+    CHECK(results[5].get() == nullopt);
+
+    CHECK(static_cast<Integer>(*results[6].get()) == 4);
+
+    CHECK(sandbox("a = 3"));
+}
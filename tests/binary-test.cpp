@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/binary.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("binary test", "[rebol] [binary]")
+{
+    SECTION("from C++")
+    {
+        std::vector<unsigned char> bytes {0x00, 0xDE, 0xAD, 0xFF};
+        Binary bin {bytes};
+
+        CHECK(bin.length() == 4);
+        CHECK(bin.data()[1] == 0xDE);
+        CHECK(static_cast<Integer>(bin[4]) == 255);
+        CHECK(hasType<Binary>(*runtime("to binary! {AB}")));
+
+        bin.data()[0] = 0x7F;
+        CHECK(static_cast<Integer>(*runtime("first", bin)) == 127);
+
+        CHECK(Binary {nullptr, 0}.isEmpty());
+    }
+
+    SECTION("file")
+    {
+        char const * path = "binary-test.bin";
+        {
+            std::ofstream file (path, std::ios::binary);
+            file << "line one\nline two\n";
+        }
+
+        Binary bin = Binary::readFile(path);
+        std::remove(path);
+
+        CHECK(bin.length() == 18);
+        CHECK(bin.data()[9] == 'l');
+        String text = static_cast<String>(*runtime("to string!", bin));
+        CHECK(static_cast<std::string>(text) == "line one\nline two\n");
+
+        CHECK_THROWS_AS(Binary::readFile(path), std::runtime_error);
+
+#ifdef __linux__
+        // Says its size is 0, but isn't empty
+        //
+        CHECK(Binary::readFile("/proc/self/status").length() > 0);
+#endif
+    }
+}
@@ -1,4 +1,7 @@
 #include <iostream>
+#include <list>
+#include <string>
+#include <vector>
 
 #include "rencpp/ren.hpp"
 
@@ -53,4 +56,105 @@ TEST_CASE("block test", "[rebol] [block]")
         CHECK(hasType<Logic>(blk2[1]));
         CHECK(hasType<Integer>(blk2[2]));
     }
+
+
+    SECTION("modification")
+    {
+        Block blk {"a b"};
+        blk.append(1);
+        blk.insert(0, Integer {0});
+        blk.poke(1, Tag {"x"});
+        CHECK(blk.isEqualTo(Block {"0 <x> b 1"}));
+
+        CHECK(blk.find(Integer {1}) == 3);
+        CHECK(blk.find(Integer {2}) == AnyArray::npos);
+
+        blk.remove(1, 2);
+        CHECK(blk.isEqualTo(Block {"0 1"}));
+        CHECK_THROWS_AS(blk.insert(3, Integer {3}), std::out_of_range);
+
+        // Copies start from the position, and deep ones copy nested blocks
+
+        Block nested = static_cast<Block>(*runtime("next [0 [1]]"));
+        Block shallow = static_cast<Block>(nested.copy(false));
+        Block deep = static_cast<Block>(nested.copy());
+        static_cast<Block>(nested[1]).append(2);
+        CHECK(shallow.isEqualTo(Block {"[1 2]"}));
+        CHECK(deep.isEqualTo(Block {"[1]"}));
+
+        nested.clear();
+        CHECK(static_cast<Block>(*runtime("head", nested)).length() == 1);
+
+        blk.reserve(100);
+        CHECK(blk.length() == 2);
+
+        Block locked = static_cast<Block>(*runtime("protect [1]"));
+        CHECK_THROWS(locked.append(2));
+        CHECK_THROWS(locked.clear());
+    }
+
+
+    SECTION("from values")
+    {
+        // Nothing is scanned, so strings aren't taken as source
+
+        Block numbers = Block::from(std::vector<int> {1, 2, 3});
+        CHECK(numbers.isEqualTo(Block {"1 2 3"}));
+
+        Block decimals = Block::from(std::vector<double> {1.5, -2.0});
+        CHECK(decimals.isEqualTo(Block {"1.5 -2.0"}));
+
+        Block strings = Block::from(
+            std::list<std::string> {"a b", "[c]"}
+        );
+        CHECK(strings.length() == 2);
+        CHECK(hasType<String>(strings[1]));
+        CHECK(strings.isEqualTo(Block {"{a b} {[c]}"}));
+
+        CHECK_THROWS(Block::from(std::vector<std::string> {"\xFF"}));
+
+        Block empty = Block::from(std::vector<int> {});
+        CHECK(empty.length() == 0);
+
+        AnyValue values[] = {Word {"x"}, Integer {10}, randomStuff};
+        Block block (values, 3, nullptr);
+        CHECK(block.length() == 3);
+        CHECK(hasType<Word>(block[1]));
+        CHECK(block[3].isEqualTo(randomStuff));
+    }
+
+
+    SECTION("extraction")
+    {
+        Block numbers {"1 2 3"};
+
+        std::vector<int64_t> integers;
+        numbers.extract(integers);
+        CHECK(integers == (std::vector<int64_t> {1, 2, 3}));
+
+        std::vector<double> decimals {9.0, 9.0, 9.0, 9.0};
+        numbers.extract<double>(decimals); // integers are taken as decimals
+        CHECK(decimals == (std::vector<double> {1.0, 2.0, 3.0}));
+
+        std::vector<std::string> strings;
+        Block {"{a} <b> %c"}.extract(strings);
+        CHECK(strings == (std::vector<std::string> {"a", "b", "c"}));
+
+        CHECK_THROWS_AS(randomStuff.extract(integers), bad_value_cast);
+
+        Block rows {"1 {one} 1.5  2 {two} 2.5"};
+        std::vector<int64_t> ids;
+        std::vector<std::string> names;
+        std::vector<double> scores;
+        rows.extractColumns(ids, names, scores);
+        CHECK(ids == (std::vector<int64_t> {1, 2}));
+        CHECK(names == (std::vector<std::string> {"one", "two"}));
+        CHECK(scores == (std::vector<double> {1.5, 2.5}));
+
+        CHECK_THROWS_AS(rows.extractColumns(ids, names), bad_value_cast);
+        CHECK_THROWS_AS(
+            Block {"1 {one} 1.5  2 3 2.5"}.extractColumns(ids, names, scores),
+            bad_value_cast
+        );
+    }
 }
@@ -0,0 +1,87 @@
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/builder.hpp"
+#include "u8text.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("string builder test", "[rebol] [builder]")
+{
+    SECTION("appends")
+    {
+        StringBuilder builder;
+        builder.append("count: ").appendInteger(-1020).appendChar(U'!');
+        builder.appendChar(U' ').appendFormed(Block {1, "two", 3.0});
+
+        CHECK(builder.length() == 23);
+        CHECK(static_cast<std::string>(builder.finish()) == "count: -1020! 1 two 3.0");
+
+        // After finish() the builder starts over
+
+        CHECK(static_cast<std::string>(builder.finish()) == "");
+    }
+
+    SECTION("growth")
+    {
+        StringBuilder builder {4};
+        std::string expected;
+        for (int n = 0; n < 1000; ++n) {
+            builder.appendInteger(n).appendChar(U',');
+            expected += std::to_string(n) + ",";
+        }
+
+        String result = builder.finish();
+        CHECK(result.length() == expected.size());
+        CHECK(static_cast<std::string>(result) == expected);
+    }
+
+    SECTION("widening")
+    {
+        StringBuilder builder;
+        builder.append(u8text(u8"café "))
+            .appendChar(U'☺')
+            .append(u8text(u8" é"));
+
+        String result = builder.finish();
+        CHECK(result.length() == 8);
+        CHECK(static_cast<std::string>(result) == u8text(u8"café ☺ é"));
+
+        CHECK_THROWS(builder.append("\xC3"));
+    }
+
+    SECTION("stream")
+    {
+        StringBuilder builder;
+        builder.append("total");
+        builder.stream() << std::setw(6) << 42 << " bytes";
+
+        // A UTF-8 sequence split across two writes
+
+        builder.stream() << '\xE2' << std::flush << "\x98\xBA";
+
+        CHECK(
+            static_cast<std::string>(builder.finish())
+                == u8text(u8"total    42 bytes☺")
+        );
+    }
+
+    SECTION("invalid stream writes")
+    {
+        StringBuilder builder;
+        builder.stream() << "ok " << "\xC3\x28 more" << std::flush;
+        CHECK(builder.stream().bad());
+
+        CHECK_THROWS_AS(builder.finish(), std::runtime_error);
+
+        // The next string starts clean
+
+        CHECK(!builder.stream().bad());
+        builder.stream() << "fine";
+        CHECK(static_cast<std::string>(builder.finish()) == "fine");
+    }
+}
@@ -84,3 +84,114 @@ TEST_CASE("context test", "[rebol] [context]")
 
     AnyContext::setFinder(oldFinder);
 }
+
+
+TEST_CASE("context from values test", "[rebol] [context]")
+{
+    // Word/value pairs, with the values taken as they are (not evaluated)
+
+    AnyValue fields[] = {
+        Word {"x"}, Integer {10},
+        Word {"y"}, Block {"1 + 2"},
+        Word {"x"}, Integer {20} // last one wins, as with MAKE OBJECT!
+    };
+    Object point (fields, 6, nullptr);
+
+    CHECK(point("x = 20"));
+    CHECK(point("[1 + 2] = y"));
+    CHECK(runtime("2 = length-of words-of", point));
+
+    AnyValue odd[] = {Word {"x"}};
+    CHECK_THROWS_AS(Object (odd, 1, nullptr), std::invalid_argument);
+
+    AnyValue notWords[] = {Integer {1}, Integer {2}};
+    CHECK_THROWS_AS(Object (notWords, 2, nullptr), std::invalid_argument);
+}
+
+
+TEST_CASE("context pool test", "[rebol] [context]")
+{
+    ContextPool pool {Object {"limit: 10"}, 2};
+    CHECK(pool.available() == 2);
+
+    {
+        ContextPool::Lease sandbox = pool.acquire();
+        CHECK(pool.available() == 1);
+
+        CHECK((*sandbox)("limit: limit * 2  limit = 20"));
+        CHECK((*sandbox)("append copy [] limit") != nullopt);
+    }
+    CHECK(pool.available() == 2);
+
+    // The variable was reset to the template's value on release
+
+    {
+        ContextPool::Lease sandbox = pool.acquire();
+        CHECK((*sandbox)("limit = 10"));
+
+        // New words force the context to be replaced rather than reset
+
+        (*sandbox)("brand-new-word: 1");
+        sandbox.release();
+        CHECK(pool.available() == 2);
+    }
+
+    // A PROTECTed variable doesn't stay protected for the next lease (the
+    // released context is the next one handed out)
+
+    {
+        ContextPool::Lease sandbox = pool.acquire();
+        (*sandbox)("protect 'limit");
+        CHECK_THROWS((*sandbox)("limit: 20"));
+    }
+    {
+        ContextPool::Lease sandbox = pool.acquire();
+        CHECK((*sandbox)("limit: 20  limit = 20"));
+    }
+    CHECK(pool.available() == 2);
+
+    {
+        ContextPool::Lease one = pool.acquire();
+        ContextPool::Lease two = pool.acquire();
+        ContextPool::Lease three = pool.acquire(); // grows the pool
+        CHECK((*three)("void? get/opt 'brand-new-word"));
+    }
+    CHECK(pool.available() == 3);
+}
+
+
+TEST_CASE("context scope test", "[rebol] [context]")
+{
+    Object outer {};
+    Object inner {};
+
+    {
+        ContextScope scopeOuter {outer};
+        runtime("z: 1");
+
+        {
+            ContextScope scopeInner {inner};
+            runtime("z: 2");
+            CHECK(runtime("z = 2"));
+        }
+
+        CHECK(runtime("z = 1"));
+    }
+
+    CHECK(outer("z = 1"));
+    CHECK(inner("z = 2"));
+
+    // An EngineScope takes precedence over the engine finder
+
+    Engine & engine = Engine::runFinder();
+    auto oldFinder = Engine::setFinder([]() -> Engine & {
+        throw std::runtime_error("Engine finder called inside EngineScope");
+    });
+
+    {
+        EngineScope scope {engine};
+        CHECK(&Engine::runFinder() == &engine);
+    }
+
+    Engine::setFinder(oldFinder);
+}
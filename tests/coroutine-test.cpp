@@ -0,0 +1,119 @@
+//
+// The coroutine layer needs C++20, so when the tests are built as C++11
+// there's nothing here to run.  Configure with -DCOROUTINES=yes to build it
+// as C++20, into test-rencpp-coroutines (see %tests/CMakeLists.txt).
+//
+
+#if __cpp_impl_coroutine
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/coroutine.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+namespace {
+
+// Started eagerly, and nothing waits on its completion but the test loop
+
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+
+// A scheduler that hands coroutines back to the thread running the test,
+// as a server would post them to its own I/O thread
+
+struct ResumeQueue {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::coroutine_handle<>> handles;
+
+    void post(std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> lock (mutex);
+        handles.push_back(handle);
+        ready.notify_one();
+    }
+
+    std::coroutine_handle<> next() {
+        std::unique_lock<std::mutex> lock (mutex);
+        ready.wait(lock, [this]() { return !handles.empty(); });
+        auto handle = handles.front();
+        handles.pop_front();
+        return handle;
+    }
+};
+
+
+struct Outcome {
+    int sum = 0;
+    bool loadError = false;
+    bool evaluationError = false;
+    bool done = false;
+};
+
+
+Task evaluateAll(Outcome & outcome) {
+    auto sum = co_await async("1 + 2");
+    {
+        EvaluatorLock lock; // the executor may be evaluating other things
+        outcome.sum = static_cast<int>(static_cast<Integer>(*sum));
+        sum = nullopt;
+    }
+
+    try {
+        co_await async("1 + {");
+    }
+    catch (load_error const &) {
+        outcome.loadError = true;
+    }
+
+    try {
+        co_await async("1 + {x}");
+    }
+    catch (evaluation_error const &) {
+        outcome.evaluationError = true;
+    }
+
+    outcome.done = true;
+}
+
+} // end anonymous namespace
+
+
+TEST_CASE("coroutine test", "[rebol] [coroutine]")
+{
+    // Static, as the async settings keep pointing at them after the test
+
+    static Executor executor {1};
+    static ResumeQueue queue;
+
+    setAsyncExecutor(executor, [](std::coroutine_handle<> handle) {
+        queue.post(handle);
+    });
+
+    Outcome outcome;
+    evaluateAll(outcome); // runs until its first co_await
+
+    while (!outcome.done)
+        queue.next().resume();
+
+    CHECK(outcome.sum == 3);
+    CHECK(outcome.loadError);
+    CHECK(outcome.evaluationError);
+}
+
+#endif
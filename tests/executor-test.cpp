@@ -0,0 +1,97 @@
+#include <exception>
+#include <future>
+#include <iostream>
+#include <string>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/executor.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("executor test", "[rebol] [executor]")
+{
+    SECTION("queued evaluations")
+    {
+        Executor executor {2};
+
+        auto sum = executor.submit("1 + 2");
+        auto failure = executor.submit("1 + {x}");
+
+        // Wait for both before taking the lock, as the workers need it to
+        // evaluate them
+
+        auto result = sum.get();
+
+        std::exception_ptr error;
+        try {
+            failure.get();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        EvaluatorLock lock; // needed to look at the results
+
+        CHECK(hasType<Integer>(result));
+        CHECK(static_cast<int>(static_cast<Integer>(*result)) == 3);
+
+        CHECK_THROWS_AS(std::rethrow_exception(error), evaluation_error);
+
+        result = nullopt;
+        error = nullptr;
+        // lock released before executor is destroyed
+    }
+
+    SECTION("native can let other evaluations run")
+    {
+        std::promise<void> signaled;
+        std::shared_future<void> signal = signaled.get_future().share();
+
+        // The first native gives up the lock and waits, which can only
+        // finish if another thread gets to run the second one.
+
+        auto waiter = Function::construct(
+            "value [integer!]",
+            [signal](Integer const & value) -> Integer {
+                {
+                    Unlocked unlocked;
+                    signal.wait();
+                }
+                return value;
+            }
+        );
+
+        auto signaler = Function::construct(
+            "value [integer!]",
+            [&signaled](Integer const & value) -> Integer {
+                signaled.set_value();
+                return value;
+            }
+        );
+
+        Executor executor {2};
+
+        std::future<optional<AnyValue>> first;
+        std::future<optional<AnyValue>> second;
+
+        {
+            EvaluatorLock lock; // the jobs copy values when submitted
+
+            first = executor.submit([waiter]() {
+                return runtime(waiter, 1);
+            });
+            second = executor.submit([signaler]() {
+                return runtime(signaler, 2);
+            });
+        }
+
+        first.wait();
+        second.wait();
+
+        EvaluatorLock lock;
+        CHECK(static_cast<int>(static_cast<Integer>(*first.get())) == 1);
+        CHECK(static_cast<int>(static_cast<Integer>(*second.get())) == 2);
+    }
+}
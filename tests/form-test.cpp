@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cassert>
 
 #include "rencpp/ren.hpp"
@@ -27,5 +28,28 @@ TEST_CASE("form test", "[rebol] [form]")
     // Smiley face: http://www.fileformat.info/info/unicode/char/263a/index.htm
 
     CHECK(String {"\n\t\xE2\x98\xBA"}.isEqualTo("\n\t\xE2\x98\xBA"));
-    CHECK(String {"^/^-^(9786)"}.isEqualTo("\n\t\xE2\x98\xBA"));
+
+    // Escapes are decoded by LOAD; String construction takes text as is
+
+    CHECK(static_cast<String>(*runtime("{^/^-^(9786)}")).isEqualTo(
+        "\n\t\xE2\x98\xBA"
+    ));
+    CHECK(String {"^/"}.length() == 2);
+}
+
+
+TEST_CASE("batch form test", "[rebol] [form]")
+{
+    std::vector<AnyValue> values {
+        Integer {1}, String {"two"}, Block {"x 3"}
+    };
+
+    std::vector<std::string> formed = form(values);
+    REQUIRE(formed.size() == 3);
+    CHECK(formed[0] == "1");
+    CHECK(formed[1] == "two");
+    CHECK(formed[2] == "x 3");
+
+    CHECK(mold(values)[1] == "\"two\"");
+    CHECK(form(std::vector<AnyValue> {}).empty());
 }
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <numeric>
 #include <string>
 
 #include "rencpp/ren.hpp"
@@ -42,3 +43,37 @@ TEST_CASE("function test", "[rebol] [function]")
 
     CHECK(static_cast<Integer>(*runtime("10 +", addFive, 100)) == 115);
 }
+
+
+TEST_CASE("block of test", "[rebol] [function]")
+{
+    BlockOf<Integer> counts {Block {"1 2 3"}};
+    CHECK(counts.size() == 3);
+    CHECK(counts[2] == 3);
+
+    CHECK_THROWS_AS(BlockOf<Integer> {Block {"1 two"}}, bad_value_cast);
+    CHECK_THROWS_AS(BlockOf<Float> {Block {"1.5 2"}}, bad_value_cast);
+
+    BlockOf<Float> prices {Block {"1.5 2.5"}};
+    CHECK(std::accumulate(prices.begin(), prices.end(), 0.0) == 4.0);
+
+    // The argument is checked once, when the function is called
+
+    auto sum = Function::construct(
+        "{Sum of integers} values [block!]",
+        [](BlockOf<Integer> const & values) -> Integer {
+            int64_t total = 0;
+            for (int64_t value : values)
+                total += value;
+            return static_cast<int>(total);
+        }
+    );
+
+    CHECK(static_cast<Integer>(*runtime(sum, Block {"10 20 30"})) == 60);
+    CHECK_THROWS(runtime(sum, Block {"10 twenty"}));
+
+    BlockOf<String> names {Block {"{a} {b}"}};
+    CHECK(names[1].str() == "b");
+    CHECK_THROWS_AS(BlockOf<String> {Block {"{a} <b>"}}, bad_value_cast);
+    CHECK(names.block().length() == 2);
+}
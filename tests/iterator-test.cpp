@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 
 #include "rencpp/ren.hpp"
+#include "u8text.hpp"
 
 using namespace ren;
 
@@ -34,13 +36,99 @@ TEST_CASE("iteration tests", "[rebol] [iterator]")
     }
 
 
+    SECTION("block elements")
+    {
+        Block blk {"1 <two> 3 [4]"};
+
+        int total = 0;
+        for (auto element : blk)
+            if (hasType<Integer>(element))
+                total += static_cast<Integer>(element);
+        CHECK(total == 4);
+
+        auto it = blk.begin();
+        ++it;
+        CHECK(hasType<Tag>(*it));
+        CHECK(!hasType<Integer>(*it));
+        CHECK_THROWS_AS(static_cast<Integer>(*it), bad_value_cast);
+        CHECK(it->isSameAs(Tag {"two"}));
+
+        AnyValue last = *--blk.end();
+        CHECK(hasType<Block>(last));
+
+        // Integer indexing is 1-based like PICK, relative to the position
+
+        CHECK(blk[2].isEqualTo(Tag {"two"}));
+        CHECK(static_cast<Block>(blk[4])[1].isEqualTo(4));
+        CHECK(static_cast<Block>(*runtime("next", blk))[1].isEqualTo(Tag {"two"}));
+        CHECK(String {"abc"}[3].isEqualTo(Character {'c'}));
+    }
+
+
+    SECTION("block algorithms")
+    {
+        Block blk {"5 3 9 1 7"};
+
+        auto it = blk.begin();
+        CHECK(blk.end() - it == 5);
+        CHECK(it[2].isEqualTo(9));
+        CHECK((it + 4)->isEqualTo(7));
+
+        it[2] = Integer {4}; // writes into the block
+        CHECK(blk.isEqualTo(Block {"5 3 4 1 7"}));
+
+        std::sort(blk.begin(), blk.end(), AnyArray::Less {});
+        CHECK(blk.isEqualTo(Block {"1 3 4 5 7"}));
+
+        auto found = std::lower_bound(
+            blk.begin(), blk.end(), Integer {4}, AnyArray::Less {}
+        );
+        CHECK(found - blk.begin() == 2);
+
+        std::reverse(blk.begin(), blk.end());
+        std::nth_element(
+            blk.begin(), blk.begin() + 2, blk.end(), AnyArray::Less {}
+        );
+        CHECK(blk[3].isEqualTo(4));
+
+        std::partition(blk.begin(), blk.end(), [](AnyArray::Element e) {
+            return static_cast<Integer>(e) > 3;
+        });
+        CHECK(static_cast<Integer>(blk[3]) > 3);
+        CHECK(static_cast<Integer>(blk[4]) <= 3);
+
+        Block decimals {"2.5 -1.0 2.0"};
+        decimals.sort();
+        CHECK(decimals.isEqualTo(Block {"-1.0 2.0 2.5"}));
+
+        Block strings {"{b} {C} {a}"};
+        strings.sort();
+        CHECK(strings.isEqualTo(Block {"{a} {b} {C}"}));
+
+        // Mixed kinds order as SORT does, and only from the position on
+
+        Block mixed = static_cast<Block>(*runtime("next [z 3 b 1.5]"));
+        mixed.sort();
+        CHECK(static_cast<Block>(*runtime("head", mixed)).isEqualTo(
+            *runtime("head sort next [z 3 b 1.5]")
+        ));
+
+        Block locked = static_cast<Block>(*runtime("protect [2 1]"));
+        CHECK_THROWS(locked.sort());
+        CHECK_THROWS(*locked.begin() = Integer {3});
+    }
+
+
     SECTION("ascii string iteration")
     {
         const char * renCstr = "Hello^/There\nWorld^/";
         const char * cppCstr = "Hello\nThere\nWorld\n";
 
         std::string s;
-        for (auto c : String {renCstr})
+        String loaded = static_cast<String>(
+            *runtime(std::string {"{"} + renCstr + "}")
+        );
+        for (auto c : loaded)
             s.push_back(static_cast<char>(c));
 
         int index = 0;
@@ -53,7 +141,7 @@ TEST_CASE("iteration tests", "[rebol] [iterator]")
 
     SECTION("unicode string iteration")
     {
-        const char * utf8Cstr = u8"MetÆducation\n";
+        const char * utf8Cstr = u8text(u8"MetÆducation\n");
 
         std::wstring ws;
         for (auto wc : String{utf8Cstr})
@@ -61,6 +149,34 @@ TEST_CASE("iteration tests", "[rebol] [iterator]")
 
         // TBD: REQUIRE correct result beyond "compiles, doesn't crash"
     }
-}
 
 
+    SECTION("string character values")
+    {
+        String str {"ab"};
+        auto it = str.begin();
+        CHECK(static_cast<char>(*it) == 'a');
+        CHECK(str.isEqualTo("ab")); // reading didn't change the string
+    }
+
+
+    SECTION("utf8 view and codepoints")
+    {
+        String ascii {"Hello World"};
+        auto view = ascii.utf8View();
+        CHECK(view.isDirect());
+        CHECK(view.str() == "Hello World");
+
+        String unicode {u8text(u8"Met\u00C6ducation \u263A")};
+        auto text = unicode.utf8View();
+        CHECK(text.str() == u8text(u8"Met\u00C6ducation \u263A"));
+
+        std::u32string decoded;
+        for (char32_t c : unicode.codepoints())
+            decoded.push_back(c);
+        CHECK(decoded == U"Met\u00C6ducation \u263A");
+        CHECK(unicode.codepoints().size() == 14);
+
+        CHECK(static_cast<std::string>(Tag {"div"}) == "<div>");
+    }
+}
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "rencpp/ren.hpp"
+#include "u8text.hpp"
 
 using namespace ren;
 
@@ -66,6 +67,81 @@ TEST_CASE("literals construction", "[rebol] [literals]")
     }
 
 
+    SECTION("string construction is not LOADed")
+    {
+        String braces {"} not {loaded"};
+        CHECK(braces.length() == 13);
+        CHECK(braces.isEqualTo("} not {loaded"));
+
+        std::string payload ("a\0b", 3); // embedded NUL survives
+        String sized {payload};
+        CHECK(sized.length() == 3);
+
+        Tag tag {"a>b"};
+        CHECK(hasType<Tag>(tag));
+        CHECK(tag.spellingOf() == "a>b");
+
+        Filename file {"my file%20.txt"};
+        CHECK(hasType<Filename>(file));
+        CHECK(file.length() == 14);
+
+        String utf8 {"\xC3\xA9t\xC3\xA9"}; // "été"
+        CHECK(utf8.length() == 3);
+
+        CHECK_THROWS_AS(String ("\xC3\x28"), std::runtime_error);
+        CHECK_THROWS_AS(String ("\xED\xA0\x80"), std::runtime_error);
+    }
+
+
+    SECTION("error and date construction")
+    {
+        Error error ("Invalid {hedgehog"); // () form, so not LOADed
+        CHECK(hasType<Error>(error));
+
+        Date date {"14-Oct-2016"};
+        CHECK(hasType<Date>(date));
+
+        CHECK_THROWS_AS(Date {"14-Oct-2016 junk"}, std::runtime_error);
+    }
+
+
+    SECTION("symbols")
+    {
+        Symbol foo {"foo"};
+        CHECK(foo == Symbol {"FOO"}); // compared as words are
+        CHECK(!foo.isSameSpellingAs(Symbol {"FOO"}));
+        CHECK(foo != "bar"_sym);
+        CHECK(foo.str() == "foo");
+
+        Word word {"foo"_sym};
+        CHECK(word.hasSpelling("foo"));
+        CHECK(!word.hasSpelling("FOO"));
+        CHECK(word.isSameWordAs(Symbol {"FOO"}));
+        CHECK(word.symbol() == foo);
+        CHECK(word.isEqualTo<Word>(foo));
+        CHECK(!word.isEqualTo<SetWord>(foo));
+
+        // Spellings are compared exactly, straight from the cell
+
+        AnyValue value = word;
+        CHECK(value.isEqualTo<Word>("foo"));
+        CHECK(!value.isEqualTo<Word>("FOO"));
+        CHECK(!value.isEqualTo<String>("foo"));
+
+        AnyValue text = String {u8text(u8"caf\u00e9 \u263a")};
+        CHECK(text.isEqualTo<String>(u8text(u8"caf\u00e9 \u263a")));
+        CHECK(!text.isEqualTo<String>(u8text(u8"caf\u00e9")));
+        CHECK(!text.isEqualTo<String>(u8text(u8"caf\u00e9 \u263a!")));
+
+        SetWord set {Symbol {"x"}};
+        set(10);
+        CHECK(static_cast<Integer>(*runtime("x")) == 10);
+
+        // picks up lib's PRINT, as a LOADed word would
+        CHECK(hasType<Function>(*GetWord {"print"_sym}.apply()));
+    }
+
+
     SECTION("string construction error")
     {
         CHECK_THROWS_AS(
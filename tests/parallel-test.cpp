@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/parallel.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("parallel map test", "[rebol] [parallel]")
+{
+    SECTION("numbers")
+    {
+        Block numbers {1, 2, 3, 4.5};
+
+        Block halves = parallelMap(numbers, [](double d) { return d / 2; });
+        CHECK(to_string(halves) == "0.5 1.0 1.5 2.25");
+
+        CHECK_THROWS_AS(
+            parallelMap(Block {1, "two"}, [](int i) { return i; }),
+            bad_value_cast
+        );
+
+        // Too big for the callable's int, rather than truncated
+
+        CHECK_THROWS_AS(
+            parallelMap(Block {"1 10000000000"}, [](int i) { return i; }),
+            bad_value_cast
+        );
+        CHECK_THROWS_AS(
+            parallelMap(Block {"-1"}, [](unsigned u) { return u; }),
+            bad_value_cast
+        );
+
+        // Nor is an unsigned result wrapped to fit an INTEGER!
+
+        CHECK_THROWS_AS(
+            parallelMap(Block {1}, [](int64_t i) -> uint64_t {
+                return static_cast<uint64_t>(i) << 63;
+            }),
+            bad_value_cast
+        );
+    }
+
+    SECTION("large block uses the pool")
+    {
+        Block big = static_cast<Block>(
+            *runtime("collect [repeat i 10000 [keep i]]")
+        );
+
+        Block squares = parallelMap(big, [](int64_t i) { return i * i; });
+
+        CHECK(static_cast<Integer>(*runtime("last", squares)) == 100000000);
+    }
+
+    SECTION("strings")
+    {
+        Block words {String {"hello"}, String {"world"}};
+
+        Block lengths = parallelMap(
+            words, [](std::string const & s) { return s.size(); }
+        );
+        CHECK(to_string(lengths) == "5 5");
+
+        CHECK_THROWS_AS(
+            parallelMap(words, [](std::string const & s) {
+                return s + "\xFF";
+            }),
+            std::runtime_error
+        );
+    }
+
+    SECTION("native")
+    {
+        registerParallelKernel("double-it", [](int i) { return i * 2; });
+
+        CHECK(
+            to_string(*runtime("parallel-map [1 2 3] 'double-it"))
+            == "2 4 6"
+        );
+        CHECK_THROWS_AS(
+            runtime("parallel-map [1 2 3] 'no-such-kernel"),
+            evaluation_error
+        );
+    }
+}
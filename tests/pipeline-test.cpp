@@ -0,0 +1,115 @@
+#include <atomic>
+#include <string>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/pipeline.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("pipeline test", "[rebol] [pipeline]")
+{
+    Function doubler = static_cast<Function>(
+        *runtime("func [records] [map-each r records [r * 2]]")
+    );
+
+    std::atomic<int64_t> total {0};
+
+    PipelineOptions options;
+    options.capacity = 64; // small, so producers feel the backpressure
+    options.minBatch = 4;
+    options.maxBatch = 32;
+    options.consumers = 2;
+
+    {
+        Pipeline<int, int64_t> pipeline {
+            doubler,
+            [](int const & i) -> AnyValue { return Integer {i}; },
+            [](AnyValue const & v) -> int64_t {
+                return static_cast<Integer>(v);
+            },
+            [&total](int64_t doubled) { total += doubled; },
+            options
+        };
+
+        for (int i = 1; i <= 1000; ++i)
+            pipeline.push(i);
+
+        pipeline.close();
+
+        PipelineStats stats = pipeline.stats();
+        CHECK(stats.pushed == 1000);
+        CHECK(stats.delivered == 1000);
+        CHECK(stats.failedBatches == 0);
+        CHECK(stats.batchSize >= options.minBatch);
+        CHECK(stats.batchSize <= options.maxBatch);
+
+        CHECK_THROWS_AS(pipeline.push(1), std::runtime_error);
+    }
+
+    CHECK(total == 1001000);
+
+    SECTION("failing batches are dropped and reported")
+    {
+        Function broken = static_cast<Function>(
+            *runtime("func [records] [fail {no}]")
+        );
+
+        std::atomic<size_t> reported {0};
+
+        Pipeline<int, int> pipeline {
+            broken,
+            [](int const & i) -> AnyValue { return Integer {i}; },
+            [](AnyValue const &) -> int { return 0; },
+            [](int) {},
+            PipelineOptions {},
+            [&reported](std::exception_ptr, size_t count) {
+                reported += count;
+            }
+        };
+
+        for (int i = 0; i < 10; ++i)
+            pipeline.push(i);
+        pipeline.close();
+
+        CHECK(reported == 10);
+        CHECK(pipeline.stats().dropped == 10);
+        CHECK(pipeline.stats().delivered == 0);
+    }
+
+    SECTION("the error handler runs unlocked, and may throw")
+    {
+        Function broken = static_cast<Function>(
+            *runtime("func [records] [fail {no}]")
+        );
+
+        std::atomic<size_t> reported {0};
+
+        Pipeline<int, int> pipeline {
+            broken,
+            [](int const & i) -> AnyValue { return Integer {i}; },
+            [](AnyValue const &) -> int { return 0; },
+            [](int) {},
+            PipelineOptions {},
+            [&reported](std::exception_ptr error, size_t count) {
+                EvaluatorLock lock; // not recursive, so mustn't be held yet
+                try {
+                    std::rethrow_exception(error);
+                }
+                catch (evaluation_error const & e) {
+                    if (hasType<Error>(e.error()))
+                        reported += count;
+                }
+                throw std::runtime_error("handler failed");
+            }
+        };
+
+        for (int i = 0; i < 10; ++i)
+            pipeline.push(i);
+        pipeline.close();
+
+        CHECK(reported == 10);
+        CHECK(pipeline.stats().dropped == 10);
+    }
+}
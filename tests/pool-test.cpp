@@ -0,0 +1,33 @@
+#include <iostream>
+#include <string>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/pool.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("engine pool test", "[rebol] [pool]")
+{
+    EnginePool pool {2, "pool-base: 1000"};
+
+    SECTION("startup code is shared")
+    {
+        auto result = pool.evaluate("pool-base + 20");
+        CHECK(hasType<Integer>(result));
+        CHECK(static_cast<int>(static_cast<Integer>(*result)) == 1020);
+    }
+
+    SECTION("molded results")
+    {
+        CHECK(*pool.evaluateMolded("reduce [1 + 2 {x}]") == "[3 {x}]");
+        CHECK(pool.evaluateMolded("()") == nullopt);
+    }
+
+    SECTION("errors cross the process boundary")
+    {
+        CHECK_THROWS_AS(pool.evaluate("1 + {x}"), evaluation_error);
+        CHECK_THROWS_AS(pool.evaluate("{unterminated"), load_error);
+    }
+}
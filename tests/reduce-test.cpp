@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/reduce.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("numeric reduction test", "[rebol] [reduce]")
+{
+    // Long enough to span chunks, with tails left over from the vector loops
+
+    std::vector<int> values;
+    for (int n = 1; n <= 1001; ++n)
+        values.push_back(n);
+    Block integers = Block::from(values);
+
+    CHECK(static_cast<Integer>(sum(integers)) == 501501);
+    CHECK(static_cast<Integer>(*minimum(integers)) == 1);
+    CHECK(static_cast<Integer>(*maximum(integers)) == 1001);
+    CHECK(mean(integers) == 501.0);
+    CHECK(variance(Block {"2 4 4 4 5 5 7 9"}) == 4.0);
+    CHECK(variance(Block {"1 3"}, true) == 2.0);
+
+    Block decimals {"1.5 -2.0 4"};
+    CHECK(hasType<Float>(sum(decimals)));
+    CHECK(static_cast<Float>(sum(decimals)) == 3.5);
+    CHECK(static_cast<Float>(*minimum(decimals)) == -2.0);
+    CHECK(static_cast<Float>(*maximum(decimals)) == 4.0);
+
+    CHECK(minimum(Block {}) == nullopt);
+    CHECK_THROWS_AS(mean(Block {}), std::domain_error);
+
+    CHECK(static_cast<Integer>(dot(Block {"1 2 3"}, Block {"4 5 6"})) == 32);
+    CHECK_THROWS_AS(
+        dot(Block {"1 2"}, Block {"1 2 3"}), std::invalid_argument
+    );
+
+    CHECK(prefixSum(Block {"1 2 3"}).isEqualTo(Block {"1 3 6"}));
+    CHECK(prefixSum(Block {"1 0.5"}).isEqualTo(Block {"1.0 1.5"}));
+
+    CHECK(
+        histogram(Block {"0 1 2.5 9 10 11"}, 0, 10, 2)
+        == (std::vector<int64_t> {3, 2})
+    );
+
+    CHECK_THROWS_AS(sum(Block {"1 two"}), bad_value_cast);
+    CHECK_THROWS_AS(
+        sum(Block {"9223372036854775807 1"}), std::overflow_error
+    );
+
+    // The natives give the same answers to Ren code
+
+    CHECK(runtime("501501 = sum-of", integers));
+    CHECK(runtime("blank? max-of []"));
+    CHECK(runtime("[1 3 6] = prefix-sum [1 2 3]"));
+    CHECK(runtime("[3 2] = histogram [0 1 2.5 9 10 11] 0 10 2"));
+    CHECK(runtime("32 = dot-product [1 2 3] [4 5 6]"));
+    CHECK(runtime("error? trap [sum-of [1 two]]"));
+}
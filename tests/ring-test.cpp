@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/ring.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("shared ring test", "[rebol] [ring]")
+{
+    SharedRing ring = SharedRing::anonymous(4096);
+
+    SECTION("round trip")
+    {
+        Block data {"foo: [1 2.5 #\"c\" {string} <tag> %file.txt]"};
+        Object obj {"x: 10 y: [a b]"};
+
+        CHECK(ring.push(data));
+        CHECK(ring.push(obj));
+        CHECK(not ring.isEmpty());
+
+        auto block = ring.pop();
+        CHECK(hasType<Block>(block));
+        CHECK(to_string(*block) == to_string(data));
+
+        auto object = ring.pop();
+        CHECK(hasType<Object>(object));
+        CHECK(static_cast<Integer>(*runtime("select", *object, "'x")) == 10);
+
+        CHECK(ring.pop() == nullopt);
+        CHECK(ring.isEmpty());
+    }
+
+    SECTION("batches and wraparound")
+    {
+        std::vector<AnyValue> values;
+        for (int i = 0; i < 100; ++i)
+            values.push_back(Block {String {std::to_string(i)}, Integer {i}});
+
+        size_t total = 0;
+        while (total < values.size()) {
+            size_t pushed = ring.push(
+                values.data() + total, values.size() - total
+            );
+            CHECK(pushed > 0);
+
+            std::vector<AnyValue> out;
+            CHECK(ring.pop(out, pushed) == pushed);
+            for (size_t n = 0; n < pushed; ++n)
+                CHECK(to_string(out[n]) == to_string(values[total + n]));
+
+            total += pushed;
+        }
+    }
+
+    SECTION("unencodable values are refused")
+    {
+        Function f = static_cast<Function>(*runtime("does [1]"));
+        CHECK_THROWS_AS(ring.push(f), bad_value_cast);
+        CHECK(ring.isEmpty());
+
+        // A block that contains itself
+
+        AnyValue cyclic = *runtime("b: copy [1] append/only b b");
+        CHECK_THROWS_AS(ring.push(cyclic), bad_value_cast);
+
+        // One which could never fit, as opposed to not fitting right now
+
+        String huge {std::string(ring.capacity(), 'x')};
+        CHECK_THROWS_AS(ring.push(huge), std::length_error);
+
+        std::vector<AnyValue> batch {Integer {1}, huge};
+        CHECK(ring.push(batch) == 1);
+        CHECK(ring.pop() != nullopt);
+        CHECK(ring.isEmpty());
+
+        // Nesting is limited to 256 arrays or objects deep
+
+        AnyValue deep = *runtime(
+            "b: copy [] loop 300 [b: reduce [b]] b"
+        );
+        CHECK_THROWS_AS(ring.push(deep), bad_value_cast);
+    }
+
+    SECTION("malformed records are rejected")
+    {
+        using internal::BinaryCodec;
+
+        std::vector<unsigned char> empty;
+        BinaryCodec::encode(Block {}, empty); // tag, then a count of 0
+        REQUIRE(empty.size() == 5);
+
+        // Blocks nested deeper than an encoder would write
+
+        std::vector<unsigned char> deep;
+        uint32_t one = 1;
+        for (int n = 0; n < 300; ++n) {
+            deep.push_back(empty[0]);
+            auto bytes = reinterpret_cast<unsigned char const *>(&one);
+            deep.insert(deep.end(), bytes, bytes + sizeof(one));
+        }
+        deep.insert(deep.end(), empty.begin(), empty.end());
+
+        AnyValue out;
+        CHECK(!BinaryCodec::decode(deep.data(), deep.size(), out));
+
+        // An object claiming more keys than there are bytes for
+
+        std::vector<unsigned char> object;
+        BinaryCodec::encode(Object {}, object);
+        uint32_t many = 0x10000000;
+        memcpy(&object[1], &many, sizeof(many));
+        CHECK(!BinaryCodec::decode(object.data(), object.size(), out));
+    }
+}
+
+
+TEST_CASE("shared ring between processes", "[rebol] [ring]")
+{
+    SharedRing ring = SharedRing::anonymous(4096);
+
+    // The child maps the ring again from the inherited descriptor, as a
+    // process it was sent to would, and is the producer
+
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+
+    if (pid == 0) {
+        bool ok;
+        try {
+            SharedRing child = SharedRing::fromFd(ring.fd());
+            ok = child.push(Block {"child 1 [2 3]"})
+                && child.push(String {"from the child"});
+        }
+        catch (...) {
+            ok = false;
+        }
+        _exit(ok ? 0 : 1);
+    }
+
+    int status;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    auto block = ring.pop();
+    REQUIRE(hasType<Block>(block));
+    CHECK(to_string(*block) == to_string(Block {"child 1 [2 3]"}));
+
+    auto text = ring.pop();
+    REQUIRE(hasType<String>(text));
+    CHECK(to_string(*text) == "from the child");
+
+    CHECK(ring.isEmpty());
+}
@@ -0,0 +1,101 @@
+#include <string>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+#include "u8text.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("string search test", "[rebol] [search]")
+{
+    // Long enough that the vector loops and the leftover tails both run
+
+    std::string text;
+    for (int n = 0; n < 100; ++n)
+        text += "GET /index.html 200\n";
+    text += "POST /login 403";
+
+    String log {text};
+
+    CHECK(log.find("POST") == text.find("POST"));
+    CHECK(log.find("/login 403") == text.find("/login 403"));
+    CHECK(log.find("missing") == AnyString::npos);
+    CHECK(log.find('P') == text.find('P'));
+    CHECK(log.findAnyOf("4P") == text.find_first_of("4P"));
+
+    CHECK(log.count('\n') == 100);
+    CHECK(log.countLines() == 101);
+    CHECK(String {"a\nb\n"}.countLines() == 2);
+    CHECK(String {""}.countLines() == 0);
+
+    std::vector<std::string> fields = String {"a,,b,c"}.split(',');
+    CHECK(fields == (std::vector<std::string> {"a", "", "b", "c"}));
+
+    // Wide series, and a needle that can't be in a byte-sized series
+
+    String wide {u8text(u8"café ☺ café ☺")};
+    CHECK(wide.find(u8text(u8"☺ caf")) == 5);
+    CHECK(wide.count(U'☺') == 2);
+    CHECK(String {"abc"}.find(u8text(u8"☺")) == AnyString::npos);
+
+    SECTION("natives")
+    {
+        runtime("log: {one^/two^/three}");
+
+        CHECK(runtime("count-lines log")->isEqualTo(Integer {3}));
+        CHECK(runtime("count-char log #\"o\"")->isEqualTo(Integer {2}));
+        CHECK(runtime("find-text log {two}")->isEqualTo(
+            *runtime("find log {two}")
+        ));
+        CHECK(runtime("find-text log #\"^/\"")->isEqualTo(
+            *runtime("find log #\"^/\"")
+        ));
+        CHECK(hasType<Blank>(*runtime("find-text log {four}")));
+
+        // Case matters, as with FIND/CASE (plain FIND ignores it)
+
+        CHECK(hasType<Blank>(*runtime("find-text log {TWO}")));
+        CHECK(hasType<Blank>(*runtime("find-text log #\"T\"")));
+        CHECK(runtime("find-text log {two}")->isEqualTo(
+            *runtime("find/case log {two}")
+        ));
+        CHECK(runtime("index-of find-any-char log {wh}")->isEqualTo(
+            Integer {6}
+        ));
+        CHECK(runtime("split-text log #\"^/\"")->isEqualTo(
+            *runtime("[{one} {two} {three}]")
+        ));
+    }
+}
+
+
+TEST_CASE("string modification test", "[rebol] [search]")
+{
+    String s {"hel"};
+    s.insert(3, "l");
+    s.append(", there");
+    s.insert(0, U'(');
+    s.append(U')');
+    CHECK(static_cast<std::string>(s) == "(hell, there)");
+    CHECK(s.find("there") == 7);
+
+    // Widens the byte-sized series
+
+    s.poke(0, U'☺');
+    s.append(u8text(u8" é"));
+    CHECK(static_cast<std::string>(s) == u8text(u8"☺hell, there) é"));
+    CHECK(s.length() == 15);
+
+    s.remove(5, 8);
+    CHECK(static_cast<std::string>(s) == u8text(u8"☺hell é"));
+
+    String copied = static_cast<String>(s.copy());
+    s.clear();
+    CHECK(s.length() == 0);
+    CHECK(copied.length() == 7);
+
+    CHECK_THROWS(s.append("\xFF"));
+    CHECK_THROWS_AS(s.poke(0, U'x'), std::out_of_range);
+}
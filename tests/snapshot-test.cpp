@@ -0,0 +1,82 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/snapshot.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("snapshot test", "[rebol] [snapshot]")
+{
+    SECTION("block")
+    {
+        Snapshot snap {
+            *runtime("[name: \"Ren\" port: 8080 ratio: 1.5 tags [a b]]")
+        };
+
+        Snapshot::View root = snap.root();
+        CHECK(root.kind() == Snapshot::Kind::Block);
+        CHECK(root.size() == 8);
+
+        CHECK(root["name"].str() == "Ren");
+        CHECK(root["PORT"].asInteger() == 8080);
+        CHECK(root["ratio"].asDecimal() == 1.5);
+        CHECK(root["port"].asDecimal() == 8080.0);
+        CHECK(!root.find("tags")); // TAGS is a WORD!, not a SET-WORD!
+
+        Snapshot::View tags = root[7];
+        CHECK(tags.kind() == Snapshot::Kind::Block);
+        CHECK(tags[1].isWord());
+        CHECK(tags[1].str() == "b");
+
+        CHECK_THROWS_AS(root["missing"], std::out_of_range);
+        CHECK_THROWS_AS(root[8], std::out_of_range);
+        CHECK_THROWS_AS(root["name"].asInteger(), bad_value_cast);
+    }
+
+    SECTION("object")
+    {
+        Snapshot snap {
+            *runtime("make object! [a: 1 inner: make object! [b: {x}]]")
+        };
+
+        Snapshot::View root = snap.root();
+        CHECK(root.isObject());
+        CHECK(root.keyAt(0) == "a");
+        CHECK(root.keyAt(1) == "inner");
+        CHECK(root["inner"]["b"].str() == "x");
+    }
+
+    SECTION("other types and errors")
+    {
+        Snapshot snap {*runtime("[1-Jan-2000 #\"c\" _]")};
+        CHECK(snap.root()[0].kind() == Snapshot::Kind::Other);
+        CHECK(snap.root()[1].asChar() == 'c');
+        CHECK(snap.root()[2].kind() == Snapshot::Kind::Blank);
+
+        CHECK_THROWS(Snapshot {*runtime("b: copy [] append/only b b b")});
+        CHECK_THROWS_AS(Snapshot {*runtime("[:append]")}, bad_value_cast);
+    }
+
+    SECTION("threads")
+    {
+        Snapshot snap {*runtime("collect [repeat i 1000 [keep i]]")};
+
+        std::vector<int64_t> sums (4, 0);
+        std::vector<std::thread> threads;
+        for (size_t n = 0; n < sums.size(); ++n) {
+            threads.emplace_back([&snap, &sums, n]() {
+                for (Snapshot::View item : snap.root())
+                    sums[n] += item.asInteger();
+            });
+        }
+        for (auto & thread : threads)
+            thread.join();
+
+        for (int64_t sum : sums)
+            CHECK(sum == 500500);
+    }
+}
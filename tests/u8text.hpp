@@ -0,0 +1,18 @@
+#ifndef RENCPP_TESTS_U8TEXT_HPP
+#define RENCPP_TESTS_U8TEXT_HPP
+
+//
+// In C++20 a u8"..." literal is an array of char8_t, which doesn't convert
+// to char const * (or compare with a std::string).  The tests are built as
+// C++11 and as C++20 (see %tests/CMakeLists.txt), so u8 literals go through
+// this to get their bytes as char under either standard:
+//
+//     String {u8text(u8"café")}
+//
+
+template <class C>
+inline char const * u8text(C const * text) {
+    return reinterpret_cast<char const *>(text);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include <cstdint>
+#include <vector>
+
+#include "rencpp/ren.hpp"
+#include "rencpp/vector.hpp"
+
+using namespace ren;
+
+#include "catch.hpp"
+
+TEST_CASE("vector test", "[rebol] [vector]")
+{
+    SECTION("from C++")
+    {
+        std::vector<int32_t> values {10, -20, 30};
+        Vector<int32_t> vec {values};
+
+        CHECK(vec.length() == 3);
+        CHECK(vec.data()[1] == -20);
+        CHECK(static_cast<Integer>(vec[3]) == 30);
+
+        // The data is shared with the value, not copied out
+
+        vec.data()[0] = 5;
+        CHECK(static_cast<Integer>(*runtime("first", vec)) == 5);
+
+        std::vector<double> decimals {0.5, 1.5};
+        Vector<double> dvec {decimals};
+        CHECK(static_cast<Float>(*runtime("last", dvec)) == 1.5);
+    }
+
+    SECTION("from the runtime")
+    {
+        AnyValue made = *runtime("make vector! [integer! 16 [1 2 3]]");
+
+        CHECK(hasType<Vector<int16_t>>(made));
+        CHECK(!hasType<Vector<int32_t>>(made));
+        CHECK_THROWS_AS(
+            static_cast<Vector<uint16_t>>(made), bad_value_cast
+        );
+
+        auto vec = static_cast<Vector<int16_t>>(made);
+        ++vec;
+        CHECK(vec.length() == 2);
+        CHECK(vec.data()[0] == 2);
+    }
+}